@@ -1,7 +1,19 @@
+// Build: nvcc -O3 -arch=sm_80 matmul.cu -lcublas -o matmul
+// (BF16 and TF32 WMMA need compute capability 8.0 or newer)
+
 #include <cstdio>
 #include <cstdlib>
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
 #include <cuda_runtime.h>
+#include <cuda_fp16.h>
+#include <cuda_bf16.h>
+#include <cublas_v2.h>
+#include <mma.h>
 
 void checkCuda(cudaError_t err) {
     if (err != cudaSuccess) {
@@ -10,6 +22,13 @@ void checkCuda(cudaError_t err) {
     }
 }
 
+void checkCublas(cublasStatus_t status) {
+    if (status != CUBLAS_STATUS_SUCCESS) {
+        fprintf(stderr, "cuBLAS error: %s\n", cublasGetStatusString(status));
+        exit(EXIT_FAILURE);
+    }
+}
+
 template<typename T>
 __global__ void matmul(const T* A, const T* B, T* C, int N) {
     int row = blockIdx.y * blockDim.y + threadIdx.y;
@@ -24,18 +43,387 @@ __global__ void matmul(const T* A, const T* B, T* C, int N) {
     }
 }
 
+// Shared-memory tiled kernel: every block stages a TILE x TILE tile of A and
+// of B in shared memory, so each element is read from global memory N / TILE
+// times instead of N times. One output per thread.
+template<typename T, int TILE>
+__global__ void matmul_tiled(const T* A, const T* B, T* C, int N) {
+    __shared__ T As[TILE][TILE];
+    __shared__ T Bs[TILE][TILE];
+
+    int row = blockIdx.y * TILE + threadIdx.y;
+    int col = blockIdx.x * TILE + threadIdx.x;
+
+    T sum = 0;
+    for (int k0 = 0; k0 < N; k0 += TILE) {
+        int a_col = k0 + threadIdx.x;
+        int b_row = k0 + threadIdx.y;
+        As[threadIdx.y][threadIdx.x] = (row < N && a_col < N) ? A[row * N + a_col] : T(0);
+        Bs[threadIdx.y][threadIdx.x] = (b_row < N && col < N) ? B[b_row * N + col] : T(0);
+        __syncthreads();
+
+        #pragma unroll
+        for (int k = 0; k < TILE; ++k) {
+            sum += As[threadIdx.y][k] * Bs[k][threadIdx.x];
+        }
+        __syncthreads();
+    }
+
+    if (row < N && col < N) {
+        C[row * N + col] = sum;
+    }
+}
+
+// Tiled kernel with register blocking: a block computes a BM x BN tile of C
+// with (BM / TM) x (BN / TN) threads, each thread accumulating a TM x TN
+// sub-tile in registers. The K dimension is walked in steps of BK through
+// shared memory; A is stored transposed so that the per-thread column loads
+// are contiguous.
+//
+// General form C (+)= A * B with an M x K matrix A and a K x N matrix B in
+// row-major order with leading dimensions lda, ldb and ldc. With accumulate
+// set, the product is added to C, which lets the out-of-core mode sum over
+// K panels.
+template<typename T, int BM, int BN, int BK, int TM, int TN>
+__global__ void matmul_regblock(const T* A, const T* B, T* C, int M, int N, int K,
+                                int lda, int ldb, int ldc, bool accumulate) {
+    constexpr int THREADS = (BM / TM) * (BN / TN);
+
+    __shared__ T As[BK][BM];
+    __shared__ T Bs[BK][BN];
+
+    const int tid = threadIdx.y * blockDim.x + threadIdx.x;
+    const int block_row = blockIdx.y * BM;
+    const int block_col = blockIdx.x * BN;
+
+    T acc[TM][TN];
+    #pragma unroll
+    for (int i = 0; i < TM; ++i) {
+        #pragma unroll
+        for (int j = 0; j < TN; ++j) {
+            acc[i][j] = 0;
+        }
+    }
+
+    T reg_a[TM];
+    T reg_b[TN];
+
+    for (int k0 = 0; k0 < K; k0 += BK) {
+        for (int idx = tid; idx < BM * BK; idx += THREADS) {
+            int r = idx / BK;
+            int c = idx % BK;
+            int gr = block_row + r;
+            int gc = k0 + c;
+            As[c][r] = (gr < M && gc < K) ? A[(size_t)gr * lda + gc] : T(0);
+        }
+        for (int idx = tid; idx < BK * BN; idx += THREADS) {
+            int r = idx / BN;
+            int c = idx % BN;
+            int gr = k0 + r;
+            int gc = block_col + c;
+            Bs[r][c] = (gr < K && gc < N) ? B[(size_t)gr * ldb + gc] : T(0);
+        }
+        __syncthreads();
+
+        #pragma unroll
+        for (int k = 0; k < BK; ++k) {
+            #pragma unroll
+            for (int i = 0; i < TM; ++i) {
+                reg_a[i] = As[k][threadIdx.y * TM + i];
+            }
+            #pragma unroll
+            for (int j = 0; j < TN; ++j) {
+                reg_b[j] = Bs[k][threadIdx.x * TN + j];
+            }
+            #pragma unroll
+            for (int i = 0; i < TM; ++i) {
+                #pragma unroll
+                for (int j = 0; j < TN; ++j) {
+                    acc[i][j] += reg_a[i] * reg_b[j];
+                }
+            }
+        }
+        __syncthreads();
+    }
+
+    #pragma unroll
+    for (int i = 0; i < TM; ++i) {
+        int row = block_row + threadIdx.y * TM + i;
+        #pragma unroll
+        for (int j = 0; j < TN; ++j) {
+            int col = block_col + threadIdx.x * TN + j;
+            if (row < M && col < N) {
+                T* c = &C[(size_t)row * ldc + col];
+                *c = accumulate ? *c + acc[i][j] : acc[i][j];
+            }
+        }
+    }
+}
+
+// Input precisions of the tensor-core kernel. storage is the element type of
+// A and B in global memory, element the WMMA fragment type and K the depth of
+// one mma_sync. TF32 has no storage type of its own: the inputs stay float and
+// are rounded in the fragments.
+struct Fp16 {
+    using storage = half;
+    using element = half;
+    static constexpr int K = 16;
+    __device__ static storage from_float(float v) { return __float2half(v); }
+    template<typename F> __device__ static void round(F&) {}
+};
+
+struct Bf16 {
+    using storage = __nv_bfloat16;
+    using element = __nv_bfloat16;
+    static constexpr int K = 16;
+    __device__ static storage from_float(float v) { return __float2bfloat16(v); }
+    template<typename F> __device__ static void round(F&) {}
+};
+
+struct Tf32 {
+    using storage = float;
+    using element = nvcuda::wmma::precision::tf32;
+    static constexpr int K = 8;
+    __device__ static storage from_float(float v) { return v; }
+    template<typename F> __device__ static void round(F& frag) {
+        for (int i = 0; i < frag.num_elements; ++i) {
+            frag.x[i] = nvcuda::wmma::__float_to_tf32(frag.x[i]);
+        }
+    }
+};
+
+template<typename P>
+__global__ void convert_input(const float* src, typename P::storage* dst, size_t n) {
+    size_t i = (size_t)blockIdx.x * blockDim.x + threadIdx.x;
+    if (i < n) {
+        dst[i] = P::from_float(src[i]);
+    }
+}
+
+// Tensor-core kernel: every warp computes one 16 x 16 tile of C with FP32
+// accumulation, loading its A and B fragments straight from global memory.
+// N must be a multiple of 16.
+template<typename P>
+__global__ void matmul_wmma(const typename P::storage* A, const typename P::storage* B,
+                            float* C, int N) {
+    using namespace nvcuda;
+
+    const int tile_row = (blockIdx.y * blockDim.y + threadIdx.y) * 16;
+    const int tile_col = (blockIdx.x * (blockDim.x / 32) + threadIdx.x / 32) * 16;
+    if (tile_row >= N || tile_col >= N) {
+        return;
+    }
+
+    wmma::fragment<wmma::matrix_a, 16, 16, P::K, typename P::element, wmma::row_major> a;
+    wmma::fragment<wmma::matrix_b, 16, 16, P::K, typename P::element, wmma::row_major> b;
+    wmma::fragment<wmma::accumulator, 16, 16, P::K, float> acc;
+    wmma::fill_fragment(acc, 0.0f);
+
+    for (int k = 0; k < N; k += P::K) {
+        wmma::load_matrix_sync(a, A + (size_t)tile_row * N + k, N);
+        wmma::load_matrix_sync(b, B + (size_t)k * N + tile_col, N);
+        P::round(a);
+        P::round(b);
+        wmma::mma_sync(acc, a, b, acc);
+    }
+
+    wmma::store_matrix_sync(C + (size_t)tile_row * N + tile_col, acc, N, wmma::mem_row_major);
+}
+
+enum class Kernel {
+    Naive, Tiled, RegBlock, Cublas, WmmaFp16, WmmaBf16, WmmaTf32, OutOfCore, MultiGpu
+};
+
+const char* kernel_name(Kernel kernel) {
+    switch (kernel) {
+    case Kernel::Naive:    return "naive";
+    case Kernel::Tiled:    return "tiled";
+    case Kernel::RegBlock: return "regblock";
+    case Kernel::Cublas:   return "cublas";
+    case Kernel::WmmaFp16: return "wmma-fp16";
+    case Kernel::WmmaBf16: return "wmma-bf16";
+    case Kernel::WmmaTf32: return "wmma-tf32";
+    case Kernel::OutOfCore: return "outofcore";
+    case Kernel::MultiGpu: return "multigpu";
+    }
+    return "?";
+}
+
+
+// Tile sizes of the kernels used by run_benchmark
+constexpr int TL_TILE = 16;
+constexpr int RB_BM = 64, RB_BN = 64, RB_BK = 8, RB_TM = 4, RB_TN = 4;
+constexpr int WMMA_WARPS_X = 4, WMMA_WARPS_Y = 4;
+
+// C = A * B in row-major order is C^T = B^T * A^T in cuBLAS' column-major view
+void cublas_gemm(cublasHandle_t handle, const float* A, const float* B, float* C, int N) {
+    const float one = 1.0f, zero = 0.0f;
+    checkCublas(cublasSgemm(handle, CUBLAS_OP_N, CUBLAS_OP_N, N, N, N,
+                            &one, B, N, A, N, &zero, C, N));
+}
+
+void cublas_gemm(cublasHandle_t handle, const double* A, const double* B, double* C, int N) {
+    const double one = 1.0, zero = 0.0;
+    checkCublas(cublasDgemm(handle, CUBLAS_OP_N, CUBLAS_OP_N, N, N, N,
+                            &one, B, N, A, N, &zero, C, N));
+}
+
+template<typename T>
+void launch_regblock(const T* A, const T* B, T* C, int M, int N, int K, int lda, int ldb,
+                     int ldc, bool accumulate, cudaStream_t stream = 0) {
+    dim3 block(RB_BN / RB_TN, RB_BM / RB_TM);
+    dim3 grid((N + RB_BN - 1) / RB_BN, (M + RB_BM - 1) / RB_BM);
+    matmul_regblock<T, RB_BM, RB_BN, RB_BK, RB_TM, RB_TN><<<grid, block, 0, stream>>>(
+        A, B, C, M, N, K, lda, ldb, ldc, accumulate);
+}
+
+template<typename T>
+void launch_matmul(Kernel kernel, cublasHandle_t handle, const T* A, const T* B, T* C, int N) {
+    switch (kernel) {
+    case Kernel::Naive: {
+        dim3 block(16, 16);
+        dim3 grid((N + 15) / 16, (N + 15) / 16);
+        matmul<<<grid, block>>>(A, B, C, N);
+        break;
+    }
+    case Kernel::Tiled: {
+        dim3 block(TL_TILE, TL_TILE);
+        dim3 grid((N + TL_TILE - 1) / TL_TILE, (N + TL_TILE - 1) / TL_TILE);
+        matmul_tiled<T, TL_TILE><<<grid, block>>>(A, B, C, N);
+        break;
+    }
+    case Kernel::RegBlock:
+        launch_regblock(A, B, C, N, N, N, N, N, N, false);
+        break;
+    case Kernel::Cublas:
+        cublas_gemm(handle, A, B, C, N);
+        break;
+    default:
+        fprintf(stderr, "%s is not available for this type\n", kernel_name(kernel));
+        exit(EXIT_FAILURE);
+    }
+    checkCuda(cudaGetLastError());
+}
+
+template<typename P>
+void launch_wmma(const typename P::storage* A, const typename P::storage* B, float* C, int N) {
+    constexpr int rows = 16 * WMMA_WARPS_Y, cols = 16 * WMMA_WARPS_X;
+    dim3 block(32 * WMMA_WARPS_X, WMMA_WARPS_Y);
+    dim3 grid((N + cols - 1) / cols, (N + rows - 1) / rows);
+    matmul_wmma<P><<<grid, block>>>(A, B, C, N);
+    checkCuda(cudaGetLastError());
+}
+
+template<typename T>
+void fill_random(T* data, size_t n, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    for (size_t i = 0; i < n; ++i) {
+        data[i] = (T)dist(gen);
+    }
+}
+
 template<typename T>
-void run_benchmark(int N, const char* type_name) {
-    size_t bytes = N * N * sizeof(T);
+double max_error(const T* C, const T* ref, size_t n) {
+    double err = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        err = fmax(err, fabs((double)C[i] - (double)ref[i]));
+    }
+    return err;
+}
+
+// Benchmark settings from the command line
+struct BenchConfig {
+    int warmup = 2;
+    int reps = 10;
+    int size = 0;      // 0: default list of sizes
+    int tile = 4096;   // tile edge of the out-of-core mode
+    int streams = 3;   // streams of the out-of-core mode
+    FILE* csv = nullptr;
+    char gpu[256] = "";
+};
+
+struct Timing {
+    double min_ms, median_ms, p95_ms;
+};
+
+// Nearest-rank percentiles of a non-empty list of times
+Timing summarize(std::vector<double> ms) {
+    std::sort(ms.begin(), ms.end());
+    auto rank = [&](double p) { return ms[(size_t)std::ceil(p * ms.size()) - 1]; };
+    return {ms.front(), rank(0.5), rank(0.95)};
+}
+
+// Run launch() warmup times untimed, then reps times, each repetition timed
+// on the device with its own pair of events.
+template<typename F>
+Timing time_launches(const BenchConfig& cfg, F launch) {
+    for (int i = 0; i < cfg.warmup; ++i) {
+        launch();
+    }
+    checkCuda(cudaDeviceSynchronize());
+
+    std::vector<cudaEvent_t> events(2 * cfg.reps);
+    for (cudaEvent_t& e : events) {
+        checkCuda(cudaEventCreate(&e));
+    }
+    for (int i = 0; i < cfg.reps; ++i) {
+        checkCuda(cudaEventRecord(events[2 * i]));
+        launch();
+        checkCuda(cudaEventRecord(events[2 * i + 1]));
+    }
+    checkCuda(cudaEventSynchronize(events.back()));
+
+    std::vector<double> ms(cfg.reps);
+    for (int i = 0; i < cfg.reps; ++i) {
+        float t;
+        checkCuda(cudaEventElapsedTime(&t, events[2 * i], events[2 * i + 1]));
+        ms[i] = t;
+    }
+    for (cudaEvent_t e : events) {
+        checkCuda(cudaEventDestroy(e));
+    }
+
+    return summarize(ms);
+}
+
+// GFLOP/s and GB/s are derived from the median. bytes is the minimal traffic
+// of one multiplication (read A and B, write C once).
+void print_result(const BenchConfig& cfg, const char* type_name, Kernel kernel, int N,
+                  const Timing& t, double bytes, double err) {
+    double gflops = 2.0 * N * N * (double)N / (t.median_ms * 1e6);
+    double gbs = bytes / (t.median_ms * 1e6);
+    printf("%-6s %-9s N=%5d  min=%10.3f  median=%10.3f  p95=%10.3f ms  %8.1f GFLOP/s  %7.1f GB/s",
+           type_name, kernel_name(kernel), N, t.min_ms, t.median_ms, t.p95_ms, gflops, gbs);
+    if (kernel == Kernel::Cublas) {
+        printf("  (Referenz)\n");
+    } else {
+        printf("  max. Fehler=%.3e\n", err);
+    }
+
+    if (cfg.csv != nullptr) {
+        fprintf(cfg.csv, "\"%s\",%s,%s,%d,%d,%d,%.6f,%.6f,%.6f,%.3f,%.3f,%.6e\n",
+                cfg.gpu, type_name, kernel_name(kernel), N, cfg.warmup, cfg.reps,
+                t.min_ms, t.median_ms, t.p95_ms, gflops, gbs, err);
+        fflush(cfg.csv);
+    }
+}
+
+// A and B are filled with uniform random numbers in [-1, 1]. The result is
+// compared against cuBLAS SGEMM/DGEMM in the same precision.
+template<typename T>
+Timing run_benchmark(const BenchConfig& cfg, int N, const char* type_name, Kernel kernel,
+                     cublasHandle_t handle) {
+    size_t count = (size_t)N * N;
+    size_t bytes = count * sizeof(T);
     
     T *h_A = (T*)malloc(bytes);
     T *h_B = (T*)malloc(bytes);
     T *h_C = (T*)malloc(bytes);
+    T *h_ref = (T*)malloc(bytes);
     
-    for (int i = 0; i < N * N; ++i) {
-        h_A[i] = 1;
-        h_B[i] = 1;
-    }
+    fill_random(h_A, count, 1);
+    fill_random(h_B, count, 2);
     
     T *d_A, *d_B, *d_C;
     checkCuda(cudaMalloc(&d_A, bytes));
@@ -44,38 +432,450 @@ void run_benchmark(int N, const char* type_name) {
     
     checkCuda(cudaMemcpy(d_A, h_A, bytes, cudaMemcpyHostToDevice));
     checkCuda(cudaMemcpy(d_B, h_B, bytes, cudaMemcpyHostToDevice));
+
+    cublas_gemm(handle, d_A, d_B, d_C, N);
+    checkCuda(cudaMemcpy(h_ref, d_C, bytes, cudaMemcpyDeviceToHost));
     
-    dim3 block(16, 16);
-    dim3 grid((N + 15) / 16, (N + 15) / 16);
-    
-    /*matmul<<<grid, block>>>(d_A, d_B, d_C, N);
-    checkCuda(cudaDeviceSynchronize());*/
-    
-    auto start = std::chrono::high_resolution_clock::now();
-    matmul<<<grid, block>>>(d_A, d_B, d_C, N);
-    checkCuda(cudaDeviceSynchronize());
-    auto end = std::chrono::high_resolution_clock::now();
-    
-    double ms = std::chrono::duration<double, std::milli>(end - start).count();
-    printf("%-6s N=%4d  Zeit=%.3f ms\n", type_name, N, ms);
+    Timing t = time_launches(cfg, [&] {
+        launch_matmul(kernel, handle, (const T*)d_A, (const T*)d_B, d_C, N);
+    });
+
+    checkCuda(cudaMemcpy(h_C, d_C, bytes, cudaMemcpyDeviceToHost));
+    print_result(cfg, type_name, kernel, N, t, 3.0 * bytes, max_error(h_C, h_ref, count));
     
     cudaFree(d_A); cudaFree(d_B); cudaFree(d_C);
-    free(h_A); free(h_B); free(h_C);
+    free(h_A); free(h_B); free(h_C); free(h_ref);
+    return t;
+}
+
+// Same inputs as run_benchmark<float>, rounded to the input precision of P on
+// the device. Only the kernel is timed, not the conversion. The error is
+// measured against FP32 cuBLAS, so it includes the input rounding.
+template<typename P>
+void run_wmma_benchmark(const BenchConfig& cfg, int N, Kernel kernel, cublasHandle_t handle) {
+    if (N % 16 != 0) {
+        fprintf(stderr, "%s: N=%d ist kein Vielfaches von 16\n", kernel_name(kernel), N);
+        return;
+    }
+
+    size_t count = (size_t)N * N;
+    size_t bytes = count * sizeof(float);
+    size_t in_bytes = count * sizeof(typename P::storage);
+
+    float *h_A = (float*)malloc(bytes);
+    float *h_B = (float*)malloc(bytes);
+    float *h_C = (float*)malloc(bytes);
+    float *h_ref = (float*)malloc(bytes);
+
+    fill_random(h_A, count, 1);
+    fill_random(h_B, count, 2);
+
+    float *d_A, *d_B, *d_C;
+    typename P::storage *d_inA, *d_inB;
+    checkCuda(cudaMalloc(&d_A, bytes));
+    checkCuda(cudaMalloc(&d_B, bytes));
+    checkCuda(cudaMalloc(&d_C, bytes));
+    checkCuda(cudaMalloc(&d_inA, in_bytes));
+    checkCuda(cudaMalloc(&d_inB, in_bytes));
+
+    checkCuda(cudaMemcpy(d_A, h_A, bytes, cudaMemcpyHostToDevice));
+    checkCuda(cudaMemcpy(d_B, h_B, bytes, cudaMemcpyHostToDevice));
+
+    cublas_gemm(handle, d_A, d_B, d_C, N);
+    checkCuda(cudaMemcpy(h_ref, d_C, bytes, cudaMemcpyDeviceToHost));
+
+    const int threads = 256;
+    const int blocks = (int)((count + threads - 1) / threads);
+    convert_input<P><<<blocks, threads>>>(d_A, d_inA, count);
+    convert_input<P><<<blocks, threads>>>(d_B, d_inB, count);
+    checkCuda(cudaGetLastError());
+    checkCuda(cudaDeviceSynchronize());
+
+    Timing t = time_launches(cfg, [&] { launch_wmma<P>(d_inA, d_inB, d_C, N); });
+
+    checkCuda(cudaMemcpy(h_C, d_C, bytes, cudaMemcpyDeviceToHost));
+    print_result(cfg, "float", kernel, N, t, 2.0 * in_bytes + bytes,
+                 max_error(h_C, h_ref, count));
+
+    cudaFree(d_A); cudaFree(d_B); cudaFree(d_C); cudaFree(d_inA); cudaFree(d_inB);
+    free(h_A); free(h_B); free(h_C); free(h_ref);
+}
+
+// Host sample check for results that are never fully on the device: compare
+// `samples` random entries of C against a dot product in double precision.
+template<typename T>
+double sampled_error(const T* A, const T* B, const T* C, int N, int samples) {
+    std::mt19937 gen(3);
+    std::uniform_int_distribution<int> dist(0, N - 1);
+    double err = 0.0;
+    for (int s = 0; s < samples; ++s) {
+        int i = dist(gen), j = dist(gen);
+        double ref = 0.0;
+        for (int k = 0; k < N; ++k) {
+            ref += (double)A[(size_t)i * N + k] * (double)B[(size_t)k * N + j];
+        }
+        err = fmax(err, fabs((double)C[(size_t)i * N + j] - ref));
+    }
+    return err;
+}
+
+// Out-of-core mode: A, B and C stay in pinned host memory and C is computed
+// tile by tile. Every stream owns buffers for one tile of A, B and C; C tiles
+// are dealt round-robin to the streams, and for each of them the A and B tiles
+// along K are copied in with cudaMemcpy2DAsync and accumulated by the
+// register-blocked kernel. Work within a stream is ordered, so the buffers can
+// be reused without further synchronisation, while the copies of one stream
+// overlap with the kernels of the others. Device memory is
+// 3 * streams * tile^2 elements, independent of N.
+template<typename T>
+void run_outofcore_benchmark(const BenchConfig& cfg, int N, const char* type_name) {
+    const int tile = N < cfg.tile ? N : cfg.tile;
+    const int tiles = (N + tile - 1) / tile;
+    const int S = cfg.streams;
+    size_t count = (size_t)N * N;
+    size_t bytes = count * sizeof(T);
+    size_t tile_bytes = (size_t)tile * tile * sizeof(T);
+    size_t pitch = (size_t)N * sizeof(T);
+
+    T *h_A, *h_B, *h_C;
+    checkCuda(cudaMallocHost(&h_A, bytes));
+    checkCuda(cudaMallocHost(&h_B, bytes));
+    checkCuda(cudaMallocHost(&h_C, bytes));
+
+    fill_random(h_A, count, 1);
+    fill_random(h_B, count, 2);
+
+    std::vector<cudaStream_t> streams(S);
+    std::vector<T*> d_A(S), d_B(S), d_C(S);
+    for (int s = 0; s < S; ++s) {
+        checkCuda(cudaStreamCreate(&streams[s]));
+        checkCuda(cudaMalloc(&d_A[s], tile_bytes));
+        checkCuda(cudaMalloc(&d_B[s], tile_bytes));
+        checkCuda(cudaMalloc(&d_C[s], tile_bytes));
+    }
+
+    auto launch = [&] {
+        int next = 0;
+        for (int bi = 0; bi < tiles; ++bi) {
+            for (int bj = 0; bj < tiles; ++bj) {
+                const int s = next++ % S;
+                const int rows = bi * tile + tile < N ? tile : N - bi * tile;
+                const int cols = bj * tile + tile < N ? tile : N - bj * tile;
+
+                for (int bk = 0; bk < tiles; ++bk) {
+                    const int depth = bk * tile + tile < N ? tile : N - bk * tile;
+                    const T* A = h_A + (size_t)bi * tile * N + (size_t)bk * tile;
+                    const T* B = h_B + (size_t)bk * tile * N + (size_t)bj * tile;
+                    checkCuda(cudaMemcpy2DAsync(d_A[s], depth * sizeof(T), A, pitch,
+                                                depth * sizeof(T), rows,
+                                                cudaMemcpyHostToDevice, streams[s]));
+                    checkCuda(cudaMemcpy2DAsync(d_B[s], cols * sizeof(T), B, pitch,
+                                                cols * sizeof(T), depth,
+                                                cudaMemcpyHostToDevice, streams[s]));
+                    launch_regblock<T>(d_A[s], d_B[s], d_C[s], rows, cols, depth, depth,
+                                       cols, cols, bk > 0, streams[s]);
+                }
+
+                T* C = h_C + (size_t)bi * tile * N + (size_t)bj * tile;
+                checkCuda(cudaMemcpy2DAsync(C, pitch, d_C[s], cols * sizeof(T),
+                                            cols * sizeof(T), rows,
+                                            cudaMemcpyDeviceToHost, streams[s]));
+            }
+        }
+        checkCuda(cudaGetLastError());
+    };
+
+    // The events are recorded in the legacy default stream, which waits for
+    // all streams above.
+    Timing t = time_launches(cfg, launch);
+    checkCuda(cudaDeviceSynchronize());
+
+    // Host-device traffic: every C tile reads a row panel of A and a column
+    // panel of B, and C is written once
+    double traffic = (2.0 * tiles * (double)N * N + (double)N * N) * sizeof(T);
+    print_result(cfg, type_name, Kernel::OutOfCore, N, t, traffic,
+                 sampled_error(h_A, h_B, h_C, N, 1024));
+
+    for (int s = 0; s < S; ++s) {
+        cudaFree(d_A[s]); cudaFree(d_B[s]); cudaFree(d_C[s]);
+        cudaStreamDestroy(streams[s]);
+    }
+    cudaFreeHost(h_A); cudaFreeHost(h_B); cudaFreeHost(h_C);
+}
+
+// Part of C computed by one device in the multi-GPU mode
+template<typename T>
+struct DevicePart {
+    int device;
+    int row0, rows, col0, cols;
+    bool peer;    // panels come from device 0 instead of the host
+    T *A, *B, *C; // A row panel, B column panel, C block
+    cudaStream_t stream;
+    cudaEvent_t start, stop;
+    std::vector<double> kernel_ms;
+};
+
+// Multi-GPU mode: C is split into a pr x pc grid of blocks, one per visible
+// device, with pr the largest divisor of the device count not above its
+// square root. Device 0 holds A and B; every device receives the A row panel
+// and B column panel of its block from there by peer-to-peer copy, or from
+// pinned host memory if it cannot access device 0. The blocks are gathered
+// into host memory. The aggregate time covers distribution, compute and
+// gather; the per-device times cover the kernel only. single_ms is the median
+// of run_benchmark with the same kernel on one device.
+template<typename T>
+void run_multigpu_benchmark(const BenchConfig& cfg, int N, const char* type_name,
+                            double single_ms) {
+    int G;
+    checkCuda(cudaGetDeviceCount(&G));
+    int pr = (int)std::sqrt((double)G);
+    while (G % pr != 0) {
+        --pr;
+    }
+    const int pc = G / pr;
+
+    size_t count = (size_t)N * N;
+    size_t bytes = count * sizeof(T);
+    size_t pitch = (size_t)N * sizeof(T);
+
+    T *h_A, *h_B, *h_C;
+    checkCuda(cudaSetDevice(0));
+    checkCuda(cudaMallocHost(&h_A, bytes));
+    checkCuda(cudaMallocHost(&h_B, bytes));
+    checkCuda(cudaMallocHost(&h_C, bytes));
+
+    fill_random(h_A, count, 1);
+    fill_random(h_B, count, 2);
+
+    T *d_A0, *d_B0;
+    checkCuda(cudaMalloc(&d_A0, bytes));
+    checkCuda(cudaMalloc(&d_B0, bytes));
+    checkCuda(cudaMemcpy(d_A0, h_A, bytes, cudaMemcpyHostToDevice));
+    checkCuda(cudaMemcpy(d_B0, h_B, bytes, cudaMemcpyHostToDevice));
+
+    std::vector<DevicePart<T>> parts(G);
+    double traffic = 0.0;
+    for (int dev = 0; dev < G; ++dev) {
+        DevicePart<T>& p = parts[dev];
+        const int r = dev / pc, c = dev % pc;
+        p.device = dev;
+        p.row0 = (int)((long long)r * N / pr);
+        p.rows = (int)((long long)(r + 1) * N / pr) - p.row0;
+        p.col0 = (int)((long long)c * N / pc);
+        p.cols = (int)((long long)(c + 1) * N / pc) - p.col0;
+
+        checkCuda(cudaSetDevice(dev));
+        int can_access = 1;
+        if (dev != 0) {
+            checkCuda(cudaDeviceCanAccessPeer(&can_access, dev, 0));
+        }
+        if (dev != 0 && can_access) {
+            cudaError_t err = cudaDeviceEnablePeerAccess(0, 0);
+            if (err == cudaErrorPeerAccessAlreadyEnabled) {
+                cudaGetLastError(); // clear the sticky error
+            } else {
+                checkCuda(err);
+            }
+        }
+        p.peer = can_access != 0;
+
+        checkCuda(cudaMalloc(&p.A, (size_t)p.rows * N * sizeof(T)));
+        checkCuda(cudaMalloc(&p.B, (size_t)N * p.cols * sizeof(T)));
+        checkCuda(cudaMalloc(&p.C, (size_t)p.rows * p.cols * sizeof(T)));
+        checkCuda(cudaStreamCreate(&p.stream));
+        checkCuda(cudaEventCreate(&p.start));
+        checkCuda(cudaEventCreate(&p.stop));
+
+        traffic += ((double)p.rows * N + (double)N * p.cols + (double)p.rows * p.cols) *
+                   sizeof(T);
+    }
+
+    // All copies use cudaMemcpyDefault; with unified addressing the runtime
+    // picks host-to-device, device-to-device or peer transfers from the
+    // pointers.
+    auto run = [&] {
+        for (DevicePart<T>& p : parts) {
+            checkCuda(cudaSetDevice(p.device));
+            const T* A = (p.peer ? d_A0 : h_A) + (size_t)p.row0 * N;
+            const T* B = (p.peer ? d_B0 : h_B) + p.col0;
+            checkCuda(cudaMemcpyAsync(p.A, A, (size_t)p.rows * pitch, cudaMemcpyDefault,
+                                      p.stream));
+            checkCuda(cudaMemcpy2DAsync(p.B, p.cols * sizeof(T), B, pitch,
+                                        p.cols * sizeof(T), N, cudaMemcpyDefault, p.stream));
+            checkCuda(cudaEventRecord(p.start, p.stream));
+            launch_regblock<T>(p.A, p.B, p.C, p.rows, p.cols, N, N, p.cols, p.cols, false,
+                               p.stream);
+            checkCuda(cudaEventRecord(p.stop, p.stream));
+            checkCuda(cudaMemcpy2DAsync(h_C + (size_t)p.row0 * N + p.col0, pitch, p.C,
+                                        p.cols * sizeof(T), p.cols * sizeof(T), p.rows,
+                                        cudaMemcpyDefault, p.stream));
+            checkCuda(cudaGetLastError());
+        }
+        for (DevicePart<T>& p : parts) {
+            checkCuda(cudaSetDevice(p.device));
+            checkCuda(cudaStreamSynchronize(p.stream));
+        }
+    };
+
+    for (int i = 0; i < cfg.warmup; ++i) {
+        run();
+    }
+
+    std::vector<double> total_ms(cfg.reps);
+    for (int i = 0; i < cfg.reps; ++i) {
+        auto start = std::chrono::high_resolution_clock::now();
+        run();
+        auto end = std::chrono::high_resolution_clock::now();
+        total_ms[i] = std::chrono::duration<double, std::milli>(end - start).count();
+
+        for (DevicePart<T>& p : parts) {
+            float ms;
+            checkCuda(cudaEventElapsedTime(&ms, p.start, p.stop));
+            p.kernel_ms.push_back(ms);
+        }
+    }
+
+    double slowest_kernel_ms = 0.0;
+    for (DevicePart<T>& p : parts) {
+        Timing k = summarize(p.kernel_ms);
+        slowest_kernel_ms = fmax(slowest_kernel_ms, k.median_ms);
+        printf("  GPU %d  Block (%d,%d) %5d x %5d  %-4s  Kernel median=%10.3f ms\n",
+               p.device, p.device / pc, p.device % pc, p.rows, p.cols,
+               p.peer ? "P2P" : "Host", k.median_ms);
+    }
+
+    Timing t = summarize(total_ms);
+    print_result(cfg, type_name, Kernel::MultiGpu, N, t, traffic,
+                 sampled_error(h_A, h_B, h_C, N, 1024));
+    printf("  %d GPUs (%d x %d)  Effizienz: %.1f %% gesamt, %.1f %% nur Kernel\n", G, pr, pc,
+           100.0 * single_ms / (G * t.median_ms), 100.0 * single_ms / (G * slowest_kernel_ms));
+
+    for (DevicePart<T>& p : parts) {
+        checkCuda(cudaSetDevice(p.device));
+        cudaFree(p.A); cudaFree(p.B); cudaFree(p.C);
+        cudaStreamDestroy(p.stream);
+        cudaEventDestroy(p.start); cudaEventDestroy(p.stop);
+    }
+    checkCuda(cudaSetDevice(0));
+    cudaFree(d_A0); cudaFree(d_B0);
+    cudaFreeHost(h_A); cudaFreeHost(h_B); cudaFreeHost(h_C);
 }
 
-int main() {
+void usage(const char* prog) {
+    fprintf(stderr,
+            "Usage: %s [-w warmup] [-r reps] [-o file.csv] [-n size] [-t tile] [-s streams] "
+            "[naive|tiled|regblock|cublas|wmma-fp16|wmma-bf16|wmma-tf32|outofcore|multigpu]\n",
+            prog);
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char** argv) {
     printf("CUDA Matrixmultiplikation\n");
     printf("=========================\n");
+
+    BenchConfig cfg;
+    const char* csv_path = nullptr;
+    const char* selected = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+            cfg.warmup = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            cfg.reps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            csv_path = argv[++i];
+        } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            cfg.size = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            cfg.tile = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            cfg.streams = atoi(argv[++i]);
+        } else if (argv[i][0] != '-' && selected == nullptr) {
+            selected = argv[i];
+        } else {
+            usage(argv[0]);
+        }
+    }
+    if (cfg.warmup < 0 || cfg.reps < 1 || cfg.size < 0 || cfg.tile < 1 || cfg.streams < 1) {
+        usage(argv[0]);
+    }
+
+    // Optional argument: kernel to run; default all
+    const Kernel all_kernels[] = {Kernel::Naive, Kernel::Tiled, Kernel::RegBlock,
+                                  Kernel::Cublas, Kernel::WmmaFp16, Kernel::WmmaBf16,
+                                  Kernel::WmmaTf32, Kernel::OutOfCore, Kernel::MultiGpu};
+    Kernel kernels[sizeof(all_kernels) / sizeof(all_kernels[0])];
+    int num_kernels = 0;
+    for (Kernel k : all_kernels) {
+        if (selected == nullptr || strcmp(selected, kernel_name(k)) == 0) {
+            kernels[num_kernels++] = k;
+        }
+    }
+    if (num_kernels == 0) {
+        usage(argv[0]);
+    }
+
+    int device;
+    cudaDeviceProp prop;
+    checkCuda(cudaGetDevice(&device));
+    checkCuda(cudaGetDeviceProperties(&prop, device));
+    snprintf(cfg.gpu, sizeof(cfg.gpu), "%s", prop.name);
+    printf("GPU: %s, %d Warmup, %d Wiederholungen\n", cfg.gpu, cfg.warmup, cfg.reps);
+
+    // Results are appended, so runs on different GPUs can share one file
+    if (csv_path != nullptr) {
+        cfg.csv = fopen(csv_path, "a");
+        if (cfg.csv == nullptr) {
+            perror(csv_path);
+            return EXIT_FAILURE;
+        }
+        fseek(cfg.csv, 0, SEEK_END);
+        if (ftell(cfg.csv) == 0) {
+            fprintf(cfg.csv, "gpu,type,kernel,N,warmup,reps,min_ms,median_ms,p95_ms,"
+                             "gflops,gbs,max_error\n");
+        }
+    }
+
+    // The reference must not use tensor cores itself
+    cublasHandle_t handle;
+    checkCublas(cublasCreate(&handle));
+    checkCublas(cublasSetMathMode(handle, CUBLAS_PEDANTIC_MATH));
+
+    // -n replaces the list; the out-of-core mode also handles sizes beyond
+    // device memory
+    std::vector<int> sizes = {2048, 4096, 8192, 16384};
+    if (cfg.size > 0) {
+        sizes = {cfg.size};
+    }
+    for (int N : sizes) {
+        for (int k = 0; k < num_kernels; ++k) {
+            switch (kernels[k]) {
+            case Kernel::WmmaFp16: run_wmma_benchmark<Fp16>(cfg, N, kernels[k], handle); break;
+            case Kernel::WmmaBf16: run_wmma_benchmark<Bf16>(cfg, N, kernels[k], handle); break;
+            case Kernel::WmmaTf32: run_wmma_benchmark<Tf32>(cfg, N, kernels[k], handle); break;
+            case Kernel::OutOfCore:
+                run_outofcore_benchmark<float>(cfg, N, "float");
+                run_outofcore_benchmark<double>(cfg, N, "double");
+                break;
+            case Kernel::MultiGpu: {
+                // Single-GPU baseline with the same kernel
+                Timing f = run_benchmark<float>(cfg, N, "float", Kernel::RegBlock, handle);
+                run_multigpu_benchmark<float>(cfg, N, "float", f.median_ms);
+                Timing d = run_benchmark<double>(cfg, N, "double", Kernel::RegBlock, handle);
+                run_multigpu_benchmark<double>(cfg, N, "double", d.median_ms);
+                break;
+            }
+            default:
+                run_benchmark<float>(cfg, N, "float", kernels[k], handle);
+                run_benchmark<double>(cfg, N, "double", kernels[k], handle);
+                break;
+            }
+        }
+    }
     
-    run_benchmark<float>(2048, "float");
-    run_benchmark<double>(2048, "double");
-    run_benchmark<float>(4096, "float");
-    run_benchmark<double>(4096, "double");
-    run_benchmark<float>(8192, "float");
-    run_benchmark<double>(8192, "double");
-    run_benchmark<float>(16384, "float");
-    run_benchmark<double>(16384, "double");
-    
+    if (cfg.csv != nullptr) {
+        fclose(cfg.csv);
+    }
+    checkCublas(cublasDestroy(handle));
     checkCuda(cudaDeviceReset());
     return 0;
 }
@@ -0,0 +1,81 @@
+#define _GNU_SOURCE
+
+#include "affinity.h"
+
+#include <omp.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+int pcr_affinity_set(int nthreads, pcr_affinity_t policy) {
+  if (nthreads < 0) {
+    return -1; // Invalid parameter
+  }
+
+  if (nthreads > 0) {
+    omp_set_num_threads(nthreads);
+  }
+  if (policy == PCR_AFFINITY_NONE) {
+    return 0; // Success
+  }
+
+#ifdef __linux__
+  cpu_set_t allowed;
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+    return -1; // Failed to query the affinity mask
+  }
+
+  int cpus[CPU_SETSIZE];
+  int count = 0;
+  for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    if (CPU_ISSET(cpu, &allowed)) {
+      cpus[count++] = cpu;
+    }
+  }
+  if (count == 0) {
+    return -1; // No CPU available
+  }
+
+  int failed = 0;
+
+#pragma omp parallel reduction(| : failed)
+  {
+    const int tid = omp_get_thread_num();
+    const int threads = omp_get_num_threads();
+    const int slot = policy == PCR_AFFINITY_SPREAD
+                         ? (int)((long long)tid * count / threads)
+                         : tid;
+
+    cpu_set_t own;
+    CPU_ZERO(&own);
+    CPU_SET(cpus[slot % count], &own);
+    failed = sched_setaffinity(0, sizeof(own), &own) != 0;
+  }
+
+  return failed ? -1 : 0;
+#else
+  return -1; // Binding not supported on this platform
+#endif
+}
+
+int pcr_affinity_from_env(void) {
+  const char *request = getenv("PCR_AFFINITY");
+  if (request == NULL) {
+    return 0; // Nothing requested
+  }
+
+  if (strcmp(request, "none") == 0) {
+    return pcr_affinity_set(0, PCR_AFFINITY_NONE);
+  }
+  if (strcmp(request, "compact") == 0) {
+    return pcr_affinity_set(0, PCR_AFFINITY_COMPACT);
+  }
+  if (strcmp(request, "spread") == 0) {
+    return pcr_affinity_set(0, PCR_AFFINITY_SPREAD);
+  }
+
+  return -1; // Unknown policy
+}
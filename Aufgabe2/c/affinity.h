@@ -0,0 +1,78 @@
+/**
+ * @file affinity.h
+ * @brief Thread count and CPU binding of the OpenMP solvers.
+ *
+ * Pages are placed on the NUMA node of the thread that touches them first.
+ * The diagonals are first touched in parallel with the static schedule of the
+ * solvers (see diagonal_create()), which only keeps the accesses local if
+ * every thread stays on its CPU. This header offers an explicit binding for
+ * environments where OMP_PROC_BIND and OMP_PLACES are not set.
+ */
+
+#ifndef AFFINITY_H
+#define AFFINITY_H
+
+/**
+ * @enum pcr_affinity_e
+ * @brief How the threads are distributed over the CPUs of the process.
+ *
+ * @var pcr_affinity_e::PCR_AFFINITY_NONE
+ *   Do not bind the threads.
+ *
+ * @var pcr_affinity_e::PCR_AFFINITY_COMPACT
+ *   Thread t runs on the t-th allowed CPU, filling one socket first.
+ *
+ * @var pcr_affinity_e::PCR_AFFINITY_SPREAD
+ *   The threads are spread evenly over all allowed CPUs, so with the usual
+ *   CPU numbering both sockets get the same number of threads.
+ */
+enum pcr_affinity_e {
+  PCR_AFFINITY_NONE,
+  PCR_AFFINITY_COMPACT,
+  PCR_AFFINITY_SPREAD,
+};
+
+/**
+ * @typedef pcr_affinity_t
+ * @brief Convenience typedef for enum pcr_affinity_e.
+ */
+typedef enum pcr_affinity_e pcr_affinity_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Set the number of threads and bind them to CPUs.
+ *
+ * Every thread of a parallel region of nthreads threads binds itself to one
+ * CPU of the process' affinity mask. The OpenMP runtime reuses these threads
+ * for later regions of the same size.
+ *
+ * @param[in] nthreads  Number of threads for subsequent parallel regions, or
+ *                      0 to keep the current setting.
+ * @param[in] policy    Distribution of the threads over the CPUs.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ *
+ * @note Call this before creating the systems, so that their pages are first
+ *       touched by the bound threads. Binding is only supported on Linux.
+ */
+int pcr_affinity_set(int nthreads, pcr_affinity_t policy);
+
+/**
+ * @brief Apply the binding requested in the environment.
+ *
+ * Reads PCR_AFFINITY (none, compact or spread) and calls pcr_affinity_set()
+ * with the current thread count. Nothing happens if the variable is not set.
+ *
+ * @return 0 on success or if the variable is not set, non-zero error code on
+ *         failure or for an unknown value.
+ */
+int pcr_affinity_from_env(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AFFINITY_H
@@ -0,0 +1,76 @@
+#include "batch.h"
+#include "diagonal.h"
+#include "util.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+
+int triSLE_batch_create(triSLE_batch_t **batch, int count, const int *sizes,
+                        int n) {
+  if (batch == NULL || count < 0) {
+    return -1; // Invalid parameter
+  }
+
+  triSLE_batch_t *p = (triSLE_batch_t *)calloc(1, sizeof(triSLE_batch_t));
+  if (p == NULL) {
+    return -1; // Memory allocation failed
+  }
+
+  p->count = (size_t)count;
+  p->offsets = (size_t *)malloc(((size_t)count + 1) * sizeof(size_t));
+  if (p->offsets == NULL) {
+    triSLE_batch_destroy(p);
+    return -1; // Memory allocation failed
+  }
+
+  p->offsets[0] = 0;
+  for (int k = 0; k < count; k++) {
+    const int size = sizes != NULL ? sizes[k] : n;
+    if (size < 0) {
+      triSLE_batch_destroy(p);
+      return -1; // Invalid parameter
+    }
+    p->offsets[k + 1] = p->offsets[k] + (size_t)size;
+    if ((size_t)size > p->max_n) {
+      p->max_n = (size_t)size;
+    }
+  }
+
+  const int total = (int)p->offsets[count];
+
+  if (diagonal_create(&p->a, total) != 0 ||
+      diagonal_create(&p->b, total) != 0 ||
+      diagonal_create(&p->c, total) != 0 ||
+      diagonal_create(&p->d, total) != 0 ||
+      diagonal_create(&p->x, total) != 0 ||
+      diagonal_create(&p->tmp[0], total) != 0 ||
+      diagonal_create(&p->tmp[1], total) != 0 ||
+      diagonal_create(&p->tmp[2], total) != 0 ||
+      diagonal_create(&p->tmp[3], total) != 0) {
+    triSLE_batch_destroy(p);
+    return -1; // Memory allocation failed
+  }
+
+  *batch = p;
+  return 0; // Success
+}
+
+int triSLE_batch_destroy(triSLE_batch_t *batch) {
+  if (batch == NULL) {
+    return -1; // Invalid parameter
+  }
+
+  diagonal_t *diagonals[] = {batch->a,      batch->b,      batch->c,
+                             batch->d,      batch->x,      batch->tmp[0],
+                             batch->tmp[1], batch->tmp[2], batch->tmp[3]};
+  for (size_t k = 0; k < sizeof(diagonals) / sizeof(diagonals[0]); k++) {
+    if (diagonals[k] != NULL) {
+      diagonal_destroy(diagonals[k]);
+    }
+  }
+
+  FREE_IF_NOT_NULL(batch->offsets);
+  FREE_IF_NOT_NULL(batch);
+
+  return 0; // Success
+}
@@ -0,0 +1,111 @@
+/**
+ * @file batch.h
+ * @brief Batches of independent tridiagonal systems stored contiguously.
+ *
+ * This header defines a container for many independent tridiagonal systems
+ * (e.g. one per grid line of an ADI scheme). All systems of a batch share one
+ * allocation per diagonal, system k occupying the rows
+ * [offsets[k], offsets[k + 1]). The systems may have different sizes.
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "diagonal.h"
+
+#include <stddef.h>
+
+/**
+ * @struct triSLE_batch_s
+ * @brief Represents a batch of independent tridiagonal systems.
+ *
+ * @var triSLE_batch_s::count
+ *   Number of systems in the batch.
+ *
+ * @var triSLE_batch_s::offsets
+ *   Array of count + 1 row offsets. System k occupies the rows
+ *   [offsets[k], offsets[k + 1]) of every diagonal.
+ *
+ * @var triSLE_batch_s::max_n
+ *   Size of the largest system in the batch.
+ *
+ * @var triSLE_batch_s::a
+ *   Lower diagonals of all systems (first element of each system unused).
+ *
+ * @var triSLE_batch_s::b
+ *   Main diagonals of all systems.
+ *
+ * @var triSLE_batch_s::c
+ *   Upper diagonals of all systems (last element of each system unused).
+ *
+ * @var triSLE_batch_s::d
+ *   Right-hand sides of all systems.
+ *
+ * @var triSLE_batch_s::x
+ *   Solution vectors of all systems.
+ *
+ * @var triSLE_batch_s::tmp
+ *   Scratch diagonals used by pcr_batched(), allocated once with the batch.
+ */
+struct triSLE_batch_s {
+  size_t count;
+  size_t *offsets;
+  size_t max_n;
+
+  diagonal_t *a;
+  diagonal_t *b;
+  diagonal_t *c;
+  diagonal_t *d;
+
+  diagonal_t *x;
+
+  diagonal_t *tmp[4];
+};
+
+/**
+ * @typedef triSLE_batch_t
+ * @brief Convenience typedef for struct triSLE_batch_s.
+ */
+typedef struct triSLE_batch_s triSLE_batch_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Create a new batch of tridiagonal systems.
+ *
+ * Allocates all diagonals for count systems, system k having sizes[k]
+ * equations. If sizes is NULL, all systems get n equations.
+ *
+ * @param[out] batch  Pointer to triSLE_batch_t pointer where the new batch
+ *                    will be stored. Must not be NULL.
+ * @param[in]  count  Number of systems in the batch.
+ * @param[in]  sizes  Array of count system sizes, or NULL.
+ * @param[in]  n      Size of every system if sizes is NULL, ignored otherwise.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ *
+ * @note The caller is responsible for freeing the allocated memory
+ *       using triSLE_batch_destroy().
+ */
+int triSLE_batch_create(triSLE_batch_t **batch, int count, const int *sizes,
+                        int n);
+
+/**
+ * @brief Destroy a batch and free its resources.
+ *
+ * @param[in] batch  Pointer to the batch to destroy.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ *
+ * @note After calling this function, the pointer becomes invalid
+ *       and should not be used.
+ */
+int triSLE_batch_destroy(triSLE_batch_t *batch);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BATCH_H
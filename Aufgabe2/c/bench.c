@@ -0,0 +1,464 @@
+#include "affinity.h"
+#include "batch.h"
+#include "sle.h"
+#include "sle_generate.h"
+#include "sle_packed.h"
+#include "solver.h"
+#include "util.h"
+#include "workspace.h"
+
+#include <omp.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Equations per system of the batched solver, which solves n / BENCH_BATCH_N
+// independent systems instead of one system of n equations.
+#define BENCH_BATCH_N 1024
+
+// Maximum number of entries of the thread and solver lists
+#define BENCH_MAX_LIST 64
+
+// Buffers a solver needs besides the reference and work systems
+enum {
+  NEEDS_WS = 1,
+  NEEDS_PACKED = 2,
+  NEEDS_BATCH = 4,
+};
+
+// Everything allocated once per system size.
+typedef struct {
+  int n;
+  triSLE_t *reference; // generated system
+  triSLE_t *blocks;    // reference split into BENCH_BATCH_N blocks
+  triSLE_t *work;      // copy solved by the solvers, receives x
+  pcr_workspace_t *ws;
+  triSLE_packed_t *packed;
+  triSLE_batch_t *batch;
+} bench_state_t;
+
+// A solver copies its input from the reference (outside of the timed part
+// measured by start/end) and leaves the solution in work->x.
+typedef struct {
+  const char *name;
+  int needs;
+  int batched; // validated against blocks instead of reference
+  int (*run)(bench_state_t *st, timer *start, timer *end);
+} bench_solver_t;
+
+typedef struct {
+  int warmup;
+  int reps;
+  int log_min, log_max;
+  int threads[BENCH_MAX_LIST];
+  int thread_count;
+  const bench_solver_t *solvers[BENCH_MAX_LIST];
+  int solver_count;
+  triSLE_family_t family;
+  unsigned long long seed;
+  int json;
+  FILE *out;
+} bench_config_t;
+
+static int run_pcr(bench_state_t *st, timer *start, timer *end) {
+  return triSLE_copy(st->work, st->reference) != 0 ||
+         pcr(st->work, start, end) != 0;
+}
+
+static int run_fast(bench_state_t *st, timer *start, timer *end) {
+  return triSLE_copy(st->work, st->reference) != 0 ||
+         pcr_fast(st->work, start, end) != 0;
+}
+
+static int run_pcr_ws(bench_state_t *st, timer *start, timer *end) {
+  return triSLE_copy(st->work, st->reference) != 0 ||
+         pcr_ws(st->work, st->ws, start, end) != 0;
+}
+
+static int run_fused(bench_state_t *st, timer *start, timer *end) {
+  return triSLE_copy(st->work, st->reference) != 0 ||
+         pcr_fused(st->work, st->ws, 0, start, end) != 0;
+}
+
+static int run_hybrid(bench_state_t *st, timer *start, timer *end) {
+  return triSLE_copy(st->work, st->reference) != 0 ||
+         pcr_thomas(st->work, st->ws, 0, start, end) != 0;
+}
+
+static int run_thomas(bench_state_t *st, timer *start, timer *end) {
+  return triSLE_copy(st->work, st->reference) != 0 ||
+         thomas(st->work, start, end) != 0;
+}
+
+static int run_packed(bench_state_t *st, timer *start, timer *end) {
+  return triSLE_pack(st->packed, st->reference) != 0 ||
+         pcr_packed(st->packed, start, end) != 0 ||
+         triSLE_unpack(st->work, st->packed) != 0;
+}
+
+static int run_batched(bench_state_t *st, timer *start, timer *end) {
+  const size_t bytes = (size_t)st->n * sizeof(float);
+  memcpy(st->batch->a->data, st->blocks->a->data, bytes);
+  memcpy(st->batch->b->data, st->blocks->b->data, bytes);
+  memcpy(st->batch->c->data, st->blocks->c->data, bytes);
+  memcpy(st->batch->d->data, st->blocks->d->data, bytes);
+
+  if (pcr_batched(st->batch, start, end) != 0) {
+    return -1;
+  }
+
+  memcpy(st->work->x->data, st->batch->x->data, bytes);
+  return 0;
+}
+
+#if defined(PCR_BENCH_GPU)
+static int run_gpu(bench_state_t *st, timer *start, timer *end) {
+  return triSLE_copy(st->work, st->reference) != 0 ||
+         pcr_gpu(st->work, start, end) != 0;
+}
+
+static int run_gpu_fast(bench_state_t *st, timer *start, timer *end) {
+  return triSLE_copy(st->work, st->reference) != 0 ||
+         pcr_gpu_fast(st->work, start, end) != 0;
+}
+#endif
+
+static const bench_solver_t solvers[] = {
+    {"pcr", 0, 0, run_pcr},
+    {"pcr_ws", NEEDS_WS, 0, run_pcr_ws},
+    {"fast", 0, 0, run_fast},
+    {"fused", NEEDS_WS, 0, run_fused},
+    {"hybrid", NEEDS_WS, 0, run_hybrid},
+    {"thomas", 0, 0, run_thomas},
+    {"packed", NEEDS_PACKED, 0, run_packed},
+    {"batched", NEEDS_BATCH, 1, run_batched},
+#if defined(PCR_BENCH_GPU)
+    {"gpu", 0, 0, run_gpu},
+    {"gpu_fast", 0, 0, run_gpu_fast},
+#endif
+};
+
+#define SOLVER_COUNT (sizeof(solvers) / sizeof(solvers[0]))
+
+static void state_destroy(bench_state_t *st) {
+  if (st->reference != NULL) {
+    triSLE_destroy(st->reference);
+  }
+  if (st->blocks != NULL) {
+    triSLE_destroy(st->blocks);
+  }
+  if (st->work != NULL) {
+    triSLE_destroy(st->work);
+  }
+  if (st->ws != NULL) {
+    pcr_workspace_destroy(st->ws);
+  }
+  if (st->packed != NULL) {
+    triSLE_packed_destroy(st->packed);
+  }
+  if (st->batch != NULL) {
+    triSLE_batch_destroy(st->batch);
+  }
+  memset(st, 0, sizeof(*st));
+}
+
+static int state_create(bench_state_t *st, int n, int needs,
+                        const bench_config_t *cfg) {
+  memset(st, 0, sizeof(*st));
+  st->n = n;
+
+  if (triSLE_create(&st->reference, n) != 0 ||
+      triSLE_create(&st->work, n) != 0 ||
+      triSLE_generate(st->reference, cfg->family, cfg->seed) != 0 ||
+      ((needs & NEEDS_WS) && pcr_workspace_create(&st->ws, n) != 0) ||
+      ((needs & NEEDS_PACKED) && triSLE_packed_create(&st->packed, n) != 0)) {
+    state_destroy(st);
+    return -1;
+  }
+
+  if (needs & NEEDS_BATCH) {
+    const int count = n > BENCH_BATCH_N ? n / BENCH_BATCH_N : 1;
+    if (triSLE_batch_create(&st->batch, count, NULL, n / count) != 0 ||
+        (size_t)n != st->batch->offsets[count] ||
+        triSLE_create(&st->blocks, n) != 0 ||
+        triSLE_copy(st->blocks, st->reference) != 0) {
+      state_destroy(st);
+      return -1;
+    }
+
+    // Decouple the blocks, so that the batch is one block-diagonal system.
+    for (int k = 0; k < count; k++) {
+      st->blocks->a->data[st->batch->offsets[k]] = 0.0f;
+      st->blocks->c->data[st->batch->offsets[k + 1] - 1] = 0.0f;
+    }
+  }
+
+  return 0;
+}
+
+static int compare_doubles(const void *a, const void *b) {
+  const double x = *(const double *)a;
+  const double y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+// Prints one result record in the configured format.
+static void print_record(const bench_config_t *cfg, int *records,
+                         const char *solver, int n, int threads,
+                         const double *times, double gbs,
+                         const triSLE_validation_t *validation) {
+  const double min = times[0];
+  const double median = times[cfg->reps / 2];
+  const double p95 = times[(cfg->reps * 95 - 1) / 100];
+
+  if (cfg->json) {
+    fprintf(cfg->out,
+            "%s  {\"solver\": \"%s\", \"kernel\": \"%s\", \"family\": \"%s\", "
+            "\"n\": %d, \"threads\": %d, \"reps\": %d, \"min_s\": %.9f, "
+            "\"median_s\": %.9f, \"p95_s\": %.9f, \"gbs\": %.3f, "
+            "\"maxrel\": %.6e, \"residual_l2\": %.6e, "
+            "\"residual_inf\": %.6e}",
+            *records > 0 ? ",\n" : "", solver, pcr_kernel_name(),
+            triSLE_family_name(cfg->family), n, threads, cfg->reps, min,
+            median, p95, gbs, validation->maxrel, validation->residual_l2,
+            validation->residual_inf);
+  } else {
+    fprintf(cfg->out, "%s,%s,%s,%d,%d,%d,%.9f,%.9f,%.9f,%.3f,%.6e,%.6e,%.6e\n",
+            solver, pcr_kernel_name(), triSLE_family_name(cfg->family), n,
+            threads, cfg->reps, min, median, p95, gbs, validation->maxrel,
+            validation->residual_l2, validation->residual_inf);
+  }
+  fflush(cfg->out);
+  (*records)++;
+}
+
+static int run_config(const bench_config_t *cfg, bench_state_t *st,
+                      const bench_solver_t *solver, int threads, int *records,
+                      double *times) {
+  timer start, end;
+
+  for (int r = 0; r < cfg->warmup; r++) {
+    if (solver->run(st, &start, &end) != 0) {
+      return -1;
+    }
+  }
+  for (int r = 0; r < cfg->reps; r++) {
+    if (solver->run(st, &start, &end) != 0) {
+      return -1;
+    }
+    times[r] = TIME_DIFF(start, end);
+  }
+  qsort(times, (size_t)cfg->reps, sizeof(double), compare_doubles);
+
+  triSLE_validation_t validation;
+  triSLE_validate(st->work, solver->batched ? st->blocks : st->reference,
+                  &validation);
+
+  // Compulsory traffic: a, b, c and d are read and x is written once.
+  const double bytes = 5.0 * st->n * sizeof(float);
+  const double median = times[cfg->reps / 2];
+  print_record(cfg, records, solver->name, st->n, threads, times,
+               median > 0.0 ? bytes / median * 1e-9 : 0.0, &validation);
+  return 0;
+}
+
+// Parses a comma-separated list of positive integers.
+static int parse_ints(const char *arg, int *values, int max) {
+  int count = 0;
+  const char *p = arg;
+  while (*p != '\0') {
+    char *next;
+    const long value = strtol(p, &next, 10);
+    if (next == p || value <= 0 || count == max) {
+      return -1;
+    }
+    values[count++] = (int)value;
+    p = *next == ',' ? next + 1 : next;
+    if (*next != ',' && *next != '\0') {
+      return -1;
+    }
+  }
+  return count;
+}
+
+static int parse_solvers(char *arg, bench_config_t *cfg) {
+  cfg->solver_count = 0;
+  for (char *name = strtok(arg, ","); name != NULL; name = strtok(NULL, ",")) {
+    size_t k = 0;
+    while (k < SOLVER_COUNT && strcmp(name, solvers[k].name) != 0) {
+      k++;
+    }
+    if (k == SOLVER_COUNT || cfg->solver_count == BENCH_MAX_LIST) {
+      return -1; // Unknown solver
+    }
+    cfg->solvers[cfg->solver_count++] = &solvers[k];
+  }
+  return cfg->solver_count > 0 ? 0 : -1;
+}
+
+static void usage(const char *program) {
+  fprintf(stderr,
+          "Usage: %s [options]\n"
+          "  -n <lo>:<hi>  Sweep n = 2^lo .. 2^hi (default 10:24)\n"
+          "  -t <list>     Thread counts, e.g. 1,2,4 (default: powers of two "
+          "up to the maximum)\n"
+          "  -s <list>     Solvers (default: all of",
+          program);
+  for (size_t k = 0; k < SOLVER_COUNT; k++) {
+    fprintf(stderr, " %s", solvers[k].name);
+  }
+  fprintf(stderr,
+          ")\n"
+          "  -w <count>    Warmup runs per configuration (default 2)\n"
+          "  -r <count>    Timed runs per configuration (default 10)\n"
+          "  -g <name>     Matrix family (default dominant)\n"
+          "  -f csv|json   Output format (default csv)\n"
+          "  -o <file>     Write the results to a file (default stdout)\n");
+}
+
+int main(int argc, char **argv) {
+  bench_config_t cfg = {.warmup = 2,
+                        .reps = 10,
+                        .log_min = 10,
+                        .log_max = 24,
+                        .family = TRISLE_FAMILY_DOMINANT,
+                        .seed = 1234,
+                        .out = stdout};
+  const char *output = NULL;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "n:t:s:w:r:g:f:o:")) != -1) {
+    switch (opt) {
+    case 'n':
+      if (sscanf(optarg, "%d:%d", &cfg.log_min, &cfg.log_max) != 2 ||
+          cfg.log_min < 0 || cfg.log_max > 30 || cfg.log_min > cfg.log_max) {
+        usage(argv[0]);
+        return -1;
+      }
+      break;
+    case 't':
+      cfg.thread_count = parse_ints(optarg, cfg.threads, BENCH_MAX_LIST);
+      if (cfg.thread_count <= 0) {
+        usage(argv[0]);
+        return -1;
+      }
+      break;
+    case 's':
+      if (parse_solvers(optarg, &cfg) != 0) {
+        usage(argv[0]);
+        return -1;
+      }
+      break;
+    case 'w':
+      cfg.warmup = atoi(optarg);
+      break;
+    case 'r':
+      cfg.reps = atoi(optarg);
+      break;
+    case 'g':
+      if (triSLE_family_from_name(optarg, &cfg.family) != 0) {
+        usage(argv[0]);
+        return -1;
+      }
+      break;
+    case 'f':
+      if (strcmp(optarg, "csv") != 0 && strcmp(optarg, "json") != 0) {
+        usage(argv[0]);
+        return -1;
+      }
+      cfg.json = strcmp(optarg, "json") == 0;
+      break;
+    case 'o':
+      output = optarg;
+      break;
+    default:
+      usage(argv[0]);
+      return -1;
+    }
+  }
+  if (optind != argc || cfg.warmup < 0 || cfg.reps <= 0) {
+    usage(argv[0]);
+    return -1;
+  }
+
+  if (pcr_affinity_from_env() != 0) {
+    fprintf(stderr, "Invalid PCR_AFFINITY (none, compact or spread)\n");
+    return -1;
+  }
+
+  const int max_threads = omp_get_max_threads();
+  if (cfg.thread_count == 0) {
+    for (int t = 1; t < max_threads; t *= 2) {
+      cfg.threads[cfg.thread_count++] = t;
+    }
+    cfg.threads[cfg.thread_count++] = max_threads;
+  }
+  if (cfg.solver_count == 0) {
+    for (size_t k = 0; k < SOLVER_COUNT; k++) {
+      cfg.solvers[cfg.solver_count++] = &solvers[k];
+    }
+  }
+
+  int needs = 0;
+  for (int k = 0; k < cfg.solver_count; k++) {
+    needs |= cfg.solvers[k]->needs;
+  }
+
+  double *times = (double *)malloc((size_t)cfg.reps * sizeof(double));
+  if (times == NULL) {
+    return -1;
+  }
+  if (output != NULL && (cfg.out = fopen(output, "w")) == NULL) {
+    fprintf(stderr, "Failed to open %s\n", output);
+    free(times);
+    return -1;
+  }
+
+  if (cfg.json) {
+    fprintf(cfg.out, "[\n");
+  } else {
+    fprintf(cfg.out, "solver,kernel,family,n,threads,reps,min_s,median_s,"
+                     "p95_s,gbs,maxrel,residual_l2,residual_inf\n");
+  }
+
+  int records = 0;
+  int failed = 0;
+  for (int e = cfg.log_min; e <= cfg.log_max && !failed; e++) {
+    bench_state_t st;
+    if (state_create(&st, 1 << e, needs, &cfg) != 0) {
+      fprintf(stderr, "Failed to allocate n = %d\n", 1 << e);
+      failed = 1;
+      break;
+    }
+
+    for (int t = 0; t < cfg.thread_count && !failed; t++) {
+      omp_set_num_threads(cfg.threads[t]);
+      for (int k = 0; k < cfg.solver_count && !failed; k++) {
+        if (run_config(&cfg, &st, cfg.solvers[k], cfg.threads[t], &records,
+                       times) != 0) {
+          fprintf(stderr, "%s failed for n = %d\n", cfg.solvers[k]->name,
+                  st.n);
+          failed = 1;
+        }
+      }
+    }
+
+    state_destroy(&st);
+  }
+
+  if (cfg.json) {
+    fprintf(cfg.out, "\n]\n");
+  }
+
+#if defined(PCR_BENCH_GPU)
+  pcr_gpu_release();
+#endif
+
+  if (output != NULL) {
+    fclose(cfg.out);
+  }
+  free(times);
+  return failed ? -1 : 0;
+}
@@ -1,33 +1,92 @@
 #include "diagonal.h"
+#include "pcr_kernel.h"
 #include "util.h"
 
+#include <omp.h>
 #include <stdlib.h>
+#include <string.h>
+
+// Smaller arrays are zeroed by the calling thread; a parallel region would
+// cost more than the remote accesses it avoids.
+#define DIAGONAL_FIRST_TOUCH_MIN 65536
+
+void diagonal_first_touch(void *data, size_t n, size_t size) {
+  if (n < DIAGONAL_FIRST_TOUCH_MIN) {
+    memset(data, 0, n * size);
+    return;
+  }
+
+#pragma omp parallel
+  {
+    int lo, hi;
+    pcr_thread_range((int)n, omp_get_thread_num(), omp_get_num_threads(), &lo,
+                     &hi);
+    memset((char *)data + (size_t)lo * size, 0, (size_t)(hi - lo) * size);
+  }
+}
 
 int diagonal_create(diagonal_t **diag, int n) {
+  if (diag == NULL || n < 0) {
+    return -1; // Invalid parameter
+  }
+
   diagonal_t *d = (diagonal_t *)calloc(1, sizeof(diagonal_t));
   if (d == NULL) {
-    goto error;
+    return -1; // Memory allocation failed
   }
 
   d->n = (size_t)n;
-  d->data = (float *)calloc(n, sizeof(float));
+  d->data = (float *)malloc((n > 0 ? (size_t)n : 1) * sizeof(float));
   if (d->data == NULL) {
-    goto error;
+    FREE_IF_NOT_NULL(d);
+    return -1; // Memory allocation failed
   }
+  diagonal_first_touch(d->data, d->n, sizeof(float));
 
   *diag = d;
   return 0; // Success
+}
+
+int diagonal_destroy(diagonal_t *diag) {
+  if (diag == NULL) {
+    return 0; // Nothing to do
+  }
 
-error:
-  FREE_IF_NOT_NULL(d->data);
-  FREE_IF_NOT_NULL(d);
+  FREE_IF_NOT_NULL(diag->data);
+  FREE_IF_NOT_NULL(diag);
 
-  return -1; // Memory allocation failed
+  return 0; // Success
 }
 
-int diagonal_destroy(diagonal_t *diag) {
+int diagonal_d_create(diagonal_d_t **diag, int n) {
+  if (diag == NULL || n < 0) {
+    return -1; // Invalid parameter
+  }
+
+  diagonal_d_t *d = (diagonal_d_t *)calloc(1, sizeof(diagonal_d_t));
+  if (d == NULL) {
+    return -1; // Memory allocation failed
+  }
+
+  d->n = (size_t)n;
+  d->data = (double *)malloc((n > 0 ? (size_t)n : 1) * sizeof(double));
+  if (d->data == NULL) {
+    FREE_IF_NOT_NULL(d);
+    return -1; // Memory allocation failed
+  }
+  diagonal_first_touch(d->data, d->n, sizeof(double));
+
+  *diag = d;
+  return 0; // Success
+}
+
+int diagonal_d_destroy(diagonal_d_t *diag) {
+  if (diag == NULL) {
+    return 0; // Nothing to do
+  }
+
   FREE_IF_NOT_NULL(diag->data);
   FREE_IF_NOT_NULL(diag);
 
   return 0; // Success
-}
\ No newline at end of file
+}
@@ -38,6 +38,27 @@ struct diagonal_s {
  */
 typedef struct diagonal_s diagonal_t;
 
+/**
+ * @struct diagonal_d_s
+ * @brief Double precision variant of diagonal_s.
+ *
+ * @var diagonal_d_s::n
+ *   Size of the matrix (n x n). Number of diagonal elements.
+ *
+ * @var diagonal_d_s::data
+ *   Array of n double values representing the diagonal elements.
+ */
+struct diagonal_d_s {
+  size_t n;
+  double *data;
+};
+
+/**
+ * @typedef diagonal_d_t
+ * @brief Convenience typedef for struct diagonal_d_s.
+ */
+typedef struct diagonal_d_s diagonal_d_t;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -48,6 +69,10 @@ extern "C" {
  * Allocates memory for a new diagonal matrix structure and initializes
  * the data array with n float elements.
  *
+ * Large arrays are zeroed in parallel with the same static partition the
+ * solvers use (see affinity.h), so on NUMA systems every page ends up on the
+ * node of the thread that works on it.
+ *
  * @param[out] diag  Pointer to diagonal_t pointer where the new matrix
  *                   will be stored. Must not be NULL.
  * @param[in]  n     Size of the diagonal matrix (n x n).
@@ -75,6 +100,44 @@ int diagonal_create(diagonal_t **diag, int n);
  */
 int diagonal_destroy(diagonal_t *diag);
 
+/**
+ * @brief Create a new double precision diagonal matrix.
+ *
+ * @param[out] diag  Pointer to diagonal_d_t pointer where the new matrix
+ *                   will be stored. Must not be NULL.
+ * @param[in]  n     Size of the diagonal matrix (n x n).
+ *
+ * @return 0 on success, non-zero error code on failure.
+ *
+ * @see diagonal_create()
+ */
+int diagonal_d_create(diagonal_d_t **diag, int n);
+
+/**
+ * @brief Destroy a double precision diagonal matrix and free its resources.
+ *
+ * @param[in] diag  Pointer to the diagonal matrix to destroy.
+ *                  If NULL, the function has no effect.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ *
+ * @see diagonal_destroy()
+ */
+int diagonal_d_destroy(diagonal_d_t *diag);
+
+/**
+ * @brief Zero an array with the static partition of the solvers.
+ *
+ * Every page is first touched, and thereby placed, on the NUMA node of the
+ * thread that later works on it. Small arrays are zeroed by the calling
+ * thread.
+ *
+ * @param[out] data  Array of n elements.
+ * @param[in]  n     Number of elements.
+ * @param[in]  size  Size of one element in bytes.
+ */
+void diagonal_first_touch(void *data, size_t n, size_t size);
+
 #ifdef __cplusplus
 }
 #endif
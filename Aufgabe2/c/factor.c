@@ -0,0 +1,70 @@
+#include "factor.h"
+#include "diagonal.h"
+#include "util.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+
+int pcr_factor_create(pcr_factor_t **factor, int n) {
+  if (factor == NULL || n < 0) {
+    return -1; // Invalid parameter
+  }
+
+  pcr_factor_t *p = (pcr_factor_t *)calloc(1, sizeof(pcr_factor_t));
+  if (p == NULL) {
+    return -1; // Memory allocation failed
+  }
+
+  p->n = (size_t)n;
+  while (((size_t)1 << p->levels) < p->n) {
+    p->levels++;
+  }
+
+  // One extra element keeps the allocations non-empty for n = 1.
+  p->alpha = (diagonal_t **)calloc(p->levels + 1, sizeof(diagonal_t *));
+  p->gamma = (diagonal_t **)calloc(p->levels + 1, sizeof(diagonal_t *));
+  if (p->alpha == NULL || p->gamma == NULL) {
+    pcr_factor_destroy(p);
+    return -1; // Memory allocation failed
+  }
+
+  for (size_t level = 0; level < p->levels; level++) {
+    if (diagonal_create(&p->alpha[level], n) != 0 ||
+        diagonal_create(&p->gamma[level], n) != 0) {
+      pcr_factor_destroy(p);
+      return -1; // Memory allocation failed
+    }
+  }
+
+  if (diagonal_create(&p->b, n) != 0) {
+    pcr_factor_destroy(p);
+    return -1; // Memory allocation failed
+  }
+
+  *factor = p;
+  return 0; // Success
+}
+
+int pcr_factor_destroy(pcr_factor_t *factor) {
+  if (factor == NULL) {
+    return -1; // Invalid parameter
+  }
+
+  for (size_t level = 0; level < factor->levels; level++) {
+    if (factor->alpha != NULL && factor->alpha[level] != NULL) {
+      diagonal_destroy(factor->alpha[level]);
+    }
+    if (factor->gamma != NULL && factor->gamma[level] != NULL) {
+      diagonal_destroy(factor->gamma[level]);
+    }
+  }
+  if (factor->b != NULL) {
+    diagonal_destroy(factor->b);
+  }
+
+  FREE_IF_NOT_NULL(factor->alpha);
+  FREE_IF_NOT_NULL(factor->gamma);
+  FREE_IF_NOT_NULL(factor);
+
+  return 0; // Success
+}
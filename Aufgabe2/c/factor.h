@@ -0,0 +1,89 @@
+/**
+ * @file factor.h
+ * @brief Reusable PCR factorization for solves with many right-hand sides.
+ *
+ * The decoupling coefficients alpha and gamma of every PCR level and the
+ * final main diagonal only depend on a, b and c. A factorization stores them
+ * once, so every further right-hand side only pays for the updates of d (see
+ * pcr_factorize() and pcr_factor_solve()).
+ */
+
+#ifndef FACTOR_H
+#define FACTOR_H
+
+#include "diagonal.h"
+
+#include <stddef.h>
+
+/**
+ * @struct pcr_factor_s
+ * @brief PCR factorization of a tridiagonal matrix with n rows.
+ *
+ * @var pcr_factor_s::n
+ *   Number of equations.
+ *
+ * @var pcr_factor_s::levels
+ *   Number of PCR levels, ceil(log2(n)).
+ *
+ * @var pcr_factor_s::alpha
+ *   Array of levels diagonals (size n each). alpha[l]->data[i] is the factor
+ *   of row i - 2^l in the update of row i at level l, or 0 if that row does
+ *   not exist.
+ *
+ * @var pcr_factor_s::gamma
+ *   Array of levels diagonals (size n each), the same for row i + 2^l.
+ *
+ * @var pcr_factor_s::b
+ *   Main diagonal after the last level (size n).
+ *
+ * @note The factorization takes 2 * levels + 1 floats per equation.
+ */
+struct pcr_factor_s {
+  size_t n;
+  size_t levels;
+  diagonal_t **alpha;
+  diagonal_t **gamma;
+  diagonal_t *b;
+};
+
+/**
+ * @typedef pcr_factor_t
+ * @brief Convenience typedef for struct pcr_factor_s.
+ */
+typedef struct pcr_factor_s pcr_factor_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Create a new factorization for systems of n equations.
+ *
+ * @param[out] factor  Pointer to pcr_factor_t pointer where the new
+ *                     factorization will be stored. Must not be NULL.
+ * @param[in]  n       Size of the systems (number of equations).
+ *
+ * @return 0 on success, non-zero error code on failure.
+ *
+ * @note The caller is responsible for freeing the allocated memory
+ *       using pcr_factor_destroy().
+ */
+int pcr_factor_create(pcr_factor_t **factor, int n);
+
+/**
+ * @brief Destroy a factorization and free its resources.
+ *
+ * @param[in] factor  Pointer to the factorization to destroy.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ *
+ * @note After calling this function, the pointer becomes invalid
+ *       and should not be used.
+ */
+int pcr_factor_destroy(pcr_factor_t *factor);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FACTOR_H
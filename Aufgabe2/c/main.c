@@ -1,79 +1,249 @@
+#include "affinity.h"
+#include "pcr_instrument.h"
+#include "pcr_tune.h"
 #include "sle.h"
+#include "sle_generate.h"
+#include "sle_io.h"
 #include "solver.h"
 #include "util.h"
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <unistd.h>
 
 #if defined(PCR_MAIN)
 #define func(system, start, end) pcr(system, start, end)
 #define SOLVER_NAME "PCR"
+#elif defined(THOMAS_MAIN)
+#define func(system, start, end) thomas(system, start, end)
+#define SOLVER_NAME "Thomas"
+#elif defined(PCR_FAST_MAIN)
+#define func(system, start, end) pcr_fast(system, start, end)
+#define SOLVER_NAME "PCR fast"
+#elif defined(PCR_THOMAS_MAIN)
+#define func(system, start, end) solve_pcr_thomas(system, start, end)
+#define SOLVER_NAME "PCR-Thomas"
+#elif defined(PCR_TUNED_MAIN)
+#define func(system, start, end) solve_tuned(system, start, end)
+#define SOLVER_NAME "Tuned"
+#elif defined(PCR_GPU_MAIN)
+#define func(system, start, end) pcr_gpu(system, start, end)
+#define SOLVER_NAME "PCR GPU"
 #else
 #define func(system, start, end) -1
 #define SOLVER_NAME
 #error "No solver defined for main.c. "
 #endif
 
+#if defined(PCR_THOMAS_MAIN)
+static int solve_pcr_thomas(triSLE_t *system, timer *start, timer *end) {
+  pcr_workspace_t *ws = NULL;
+  if (pcr_workspace_create(&ws, (int)system->b->n) != 0) {
+    return -1; // Failed to create the workspace
+  }
+
+  const int ret = pcr_thomas(system, ws, 0, start, end);
+
+  pcr_workspace_destroy(ws);
+  return ret;
+}
+#endif
+
+#if defined(PCR_TUNED_MAIN)
+// Default file of the tuning table, overridden by PCR_TUNE_FILE
+#define PCR_TUNE_FILE ".pcr_tune"
+
+static int solve_tuned(triSLE_t *system, timer *start, timer *end) {
+  const char *path = getenv("PCR_TUNE_FILE");
+  pcr_tuner_t *tuner = NULL;
+  if (pcr_tuner_create(&tuner, path != NULL ? path : PCR_TUNE_FILE) != 0) {
+    return -1; // Failed to create the tuner
+  }
+
+  const int ret = pcr_tuned(tuner, system, start, end);
+
+  pcr_tune_entry_t entry;
+  if (ret == 0 && pcr_tuner_lookup(tuner, (int)system->b->n, &entry) == 0) {
+    static const char *names[] = {"Thomas", "PCR", "PCR-Thomas", "GPU"};
+    printf("Tuned solver: %s, %d levels, %d threads\n", names[entry.solver],
+           entry.levels, entry.threads);
+  }
+
+  pcr_tuner_destroy(tuner);
+  return ret;
+}
+#endif
+
+static void print_validation(const triSLE_validation_t *validation) {
+  printf("Max relative error: %e\n", validation->maxrel);
+  printf("MAPE value: %e%%\n", validation->mape);
+  printf("Residual L2 norm: %e\n", validation->residual_l2);
+  printf("Residual max norm: %e\n", validation->residual_inf);
+}
+
+static void usage(const char *program) {
+  fprintf(stderr,
+          "Usage: %s [-g <family>] [-r <seed>] [-w <file>] <# of equations>\n"
+          "       %s -i <file> [-o <file>] [-s <rows>]\n"
+          "  -g <name>  Matrix family: dominant, poisson, random (default) or "
+          "near-singular\n"
+          "  -r <seed>  Seed of the generated system (default 1234)\n"
+          "  -i <file>  Solve the system stored in a container\n"
+          "  -o <file>  Write the solution to a container (needs -i or -w)\n"
+          "  -w <file>  Store the generated system in a container and solve "
+          "it from there\n"
+          "  -s <rows>  Stream the system in chunks of rows equations instead "
+          "of mapping it (needs -o)\n",
+          program, program);
+}
+
 int main(int argc, char **argv) {
+  const char *input = NULL;
+  const char *output = NULL;
+  const char *save = NULL;
+  long stream_rows = 0;
+  triSLE_family_t family = TRISLE_FAMILY_RANDOM;
+  unsigned long long seed = 1234;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "g:r:i:o:w:s:")) != -1) {
+    switch (opt) {
+    case 'g':
+      if (triSLE_family_from_name(optarg, &family) != 0) {
+        usage(argv[0]);
+        return -1;
+      }
+      break;
+    case 'r':
+      seed = strtoull(optarg, NULL, 0);
+      break;
+    case 'i':
+      input = optarg;
+      break;
+    case 'o':
+      output = optarg;
+      break;
+    case 'w':
+      save = optarg;
+      break;
+    case 's':
+      stream_rows = atol(optarg);
+      break;
+    default:
+      usage(argv[0]);
+      return -1;
+    }
+  }
 
-  if (argc != 2) {
-    fprintf(stderr, "Usage: %s <# of equations>\n", argv[0]);
+  const int generated = input == NULL;
+  if ((generated && optind != argc - 1) || (!generated && optind != argc) ||
+      (input != NULL && save != NULL) ||
+      (output != NULL && input == NULL && save == NULL) ||
+      (stream_rows < 0 || (stream_rows > 0 && output == NULL))) {
+    usage(argv[0]);
     return -1;
   }
 
-  const int n = atoi(argv[1]);
+  // Bind the threads before the system is first touched
+  if (pcr_affinity_from_env() != 0) {
+    fprintf(stderr, "Invalid PCR_AFFINITY (none, compact or spread)\n");
+    return -1;
+  }
 
   triSLE_t *system = NULL;
+  triSLE_t *system_copy = NULL;
 
-  if (triSLE_create(&system, n) != 0) {
-    return -1; // Failed to create PCR system
+  if (generated) {
+    const int n = atoi(argv[optind]);
+
+    if (triSLE_create(&system, n) != 0) {
+      return -1; // Failed to create PCR system
+    }
+
+    if (triSLE_generate(system, family, seed) != 0) {
+      triSLE_destroy(system);
+      return -1; // Failed to generate PCR system
+    }
+
+    if (save != NULL) {
+      // Continue with the stored system, exactly as if it was given with -i
+      const int ret = triSLE_write(system, save);
+      triSLE_destroy(system);
+      if (ret != 0) {
+        fprintf(stderr, "Failed to write %s\n", save);
+        return -1;
+      }
+      input = save;
+    }
   }
 
-  float *lower = system->a->data;
-  float *main = system->b->data;
-  float *upper = system->c->data;
-  float *rhs = system->d->data;
+  if (stream_rows > 0) {
+    timer start_time, end_time;
 
-  srand(1234);
+    if (pcr_stream(input, output, (size_t)stream_rows, &start_time,
+                   &end_time) != 0) {
+      fprintf(stderr, "Failed to solve %s\n", input);
+      return -1;
+    }
 
-  for (int i = 0; i < n; i++) {
-    lower[i] =
-        ((i > 0) ? ((float)(drand48() * 1e-5)) : 0.0) * (rand() % 2 ? 1 : -1);
-    main[i] = (float)(drand48() * 1e2) * (rand() % 2 ? 1 : -1);
-    upper[i] = ((i < n - 1) ? ((float)(drand48() * 1e-5)) : 0.0) *
-               (rand() % 2 ? 1 : -1);
-    rhs[i] = (float)(drand48()) * (rand() % 2 ? 1 : -1);
-  }
+    TIME_PRINT(start_time, end_time, "Streamed solve time");
 
-  // copy A and rhs for verification later
+    // Validate against the mapped files, which need not fit into memory
+    if (triSLE_map_solved(&system, input, output) != 0) {
+      return -1; // Failed to map the solution
+    }
 
-  triSLE_t *system_copy = NULL;
-  if (triSLE_create(&system_copy, n) != 0) {
-    triSLE_destroy(system);
-    return -1; // Failed to create PCR system copy
+    triSLE_validation_t validation;
+    triSLE_validate(system, system, &validation);
+    print_validation(&validation);
+
+    triSLE_unmap(system);
+    return 0;
   }
 
-  if (triSLE_copy(system_copy, system) != 0) {
-    triSLE_destroy(system);
-    triSLE_destroy(system_copy);
-    return -1; // Failed to copy PCR system
+  if (input != NULL) {
+    // A second private mapping of the input keeps A and rhs for verification
+    if (triSLE_map(&system, input, output) != 0) {
+      fprintf(stderr, "Failed to map %s\n", input);
+      return -1;
+    }
+    if (triSLE_map(&system_copy, input, NULL) != 0) {
+      fprintf(stderr, "Failed to map %s\n", input);
+      triSLE_unmap(system);
+      return -1;
+    }
+  } else {
+    // copy A and rhs for verification later
+
+    if (triSLE_create(&system_copy, (int)system->b->n) != 0) {
+      triSLE_destroy(system);
+      return -1; // Failed to create PCR system copy
+    }
+
+    if (triSLE_copy(system_copy, system) != 0) {
+      triSLE_destroy(system);
+      triSLE_destroy(system_copy);
+      return -1; // Failed to copy PCR system
+    }
   }
 
+  int (*release)(triSLE_t *) = input != NULL ? triSLE_unmap : triSLE_destroy;
   timer start_time, end_time;
 
   if (func(system, &start_time, &end_time) != 0) {
-    triSLE_destroy(system);
-    triSLE_destroy(system_copy);
+    release(system);
+    release(system_copy);
     return -1; // Failed to solve the system
   }
 
   TIME_PRINT(start_time, end_time, SOLVER_NAME " solve time");
+  PCR_INSTRUMENT_DUMP(getenv("PCR_INSTRUMENT_OUTPUT"));
 
-  printf("Max relative error: %e\n",
-         triSLE_validate_maxrel(system, system_copy));
-  printf("MAPE value: %e%%\n", triSLE_validate_mape(system, system_copy));
+  triSLE_validation_t validation;
+  triSLE_validate(system, system_copy, &validation);
+  print_validation(&validation);
 
-  triSLE_destroy(system);
-  triSLE_destroy(system_copy);
+  release(system);
+  release(system_copy);
   return 0;
-}
\ No newline at end of file
+}
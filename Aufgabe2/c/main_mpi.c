@@ -0,0 +1,141 @@
+#include "pcr_mpi.h"
+#include "sle.h"
+#include "sle_generate.h"
+#include "util.h"
+
+#include <math.h>
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Row i of A x for a block whose neighbouring solution values are x_left
+// (last row of the previous rank) and x_right (first row of the next rank).
+static float row_product(triSLE_t *system, float x_left, float x_right,
+                         size_t i, int first, int last) {
+  const float *x = system->x->data;
+  const size_t m = system->b->n;
+  float result = system->b->data[i] * x[i];
+
+  if (i > 0) {
+    result += system->a->data[i] * x[i - 1];
+  } else if (!first) {
+    result += system->a->data[i] * x_left;
+  }
+
+  if (i < m - 1) {
+    result += system->c->data[i] * x[i + 1];
+  } else if (!last) {
+    result += system->c->data[i] * x_right;
+  }
+
+  return result;
+}
+
+// Same measures as triSLE_validate_maxrel() and triSLE_validate_mape(),
+// after exchanging the solution values at the block boundaries.
+static void validate(triSLE_t *system, size_t n, MPI_Comm comm, float *maxrel,
+                     float *mape) {
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  const int left = rank > 0 ? rank - 1 : MPI_PROC_NULL;
+  const int right = rank < size - 1 ? rank + 1 : MPI_PROC_NULL;
+  const float *x = system->x->data;
+  const size_t m = system->b->n;
+  float x_left = 0.0f, x_right = 0.0f;
+
+  MPI_Sendrecv(&x[m - 1], 1, MPI_FLOAT, right, 0, &x_left, 1, MPI_FLOAT, left,
+               0, comm, MPI_STATUS_IGNORE);
+  MPI_Sendrecv(&x[0], 1, MPI_FLOAT, left, 1, &x_right, 1, MPI_FLOAT, right, 1,
+               comm, MPI_STATUS_IGNORE);
+
+  float local_max = 0.0f;
+  double local_sum = 0.0;
+  for (size_t i = 0; i < m; i++) {
+    const float result =
+        row_product(system, x_left, x_right, i, left == MPI_PROC_NULL,
+                    right == MPI_PROC_NULL);
+    const float expected = system->d->data[i];
+    if (expected != 0.0f) {
+      const float relative_error = fabsf(result - expected) / fabsf(expected);
+      if (relative_error > local_max) {
+        local_max = relative_error;
+      }
+      local_sum += relative_error * 100.0;
+    } else if (result != 0.0f) {
+      local_sum += 1.0;
+    }
+  }
+
+  double sum = 0.0;
+  MPI_Reduce(&local_max, maxrel, 1, MPI_FLOAT, MPI_MAX, 0, comm);
+  MPI_Reduce(&local_sum, &sum, 1, MPI_DOUBLE, MPI_SUM, 0, comm);
+  *mape = (float)(sum / (double)n);
+}
+
+int main(int argc, char **argv) {
+  MPI_Init(&argc, &argv);
+
+  int rank, size;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+  if (argc != 2) {
+    if (rank == 0) {
+      fprintf(stderr, "Usage: %s <# of equations>\n", argv[0]);
+    }
+    MPI_Finalize();
+    return -1;
+  }
+
+  const long long n = atoll(argv[1]);
+  if (n < size) {
+    if (rank == 0) {
+      fprintf(stderr, "Need at least one equation per rank\n");
+    }
+    MPI_Finalize();
+    return -1;
+  }
+
+  // Every rank only creates its own block of rows.
+  const long long row0 = n * rank / size;
+  const long long row1 = n * (rank + 1) / size;
+  const int m = (int)(row1 - row0);
+
+  triSLE_t *system = NULL;
+  int failed = triSLE_create(&system, m) != 0;
+  MPI_Allreduce(MPI_IN_PLACE, &failed, 1, MPI_INT, MPI_LOR, MPI_COMM_WORLD);
+  if (failed) {
+    if (system != NULL) {
+      triSLE_destroy(system);
+    }
+    MPI_Finalize();
+    return -1; // Failed to create PCR system
+  }
+
+  // The blocks together form the system main.c generates for the same n
+  triSLE_generate_block(system, TRISLE_FAMILY_RANDOM, 1234, (size_t)row0,
+                        (size_t)n);
+
+  timer start_time, end_time;
+
+  if (pcr_mpi(system, MPI_COMM_WORLD, &start_time, &end_time) != 0) {
+    triSLE_destroy(system);
+    MPI_Finalize();
+    return -1; // Failed to solve the system
+  }
+
+  float maxrel, mape;
+  validate(system, (size_t)n, MPI_COMM_WORLD, &maxrel, &mape);
+
+  if (rank == 0) {
+    TIME_PRINT(start_time, end_time, "PCR MPI solve time");
+    printf("Max relative error: %e\n", maxrel);
+    printf("MAPE value: %e%%\n", mape);
+  }
+
+  triSLE_destroy(system);
+  MPI_Finalize();
+  return 0;
+}
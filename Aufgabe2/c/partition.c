@@ -0,0 +1,112 @@
+#include "partition.h"
+
+#include <stddef.h>
+
+_Static_assert(sizeof(partition_chunk_t) ==
+                   PARTITION_CHUNK_FLOATS * sizeof(float),
+               "partition_chunk_t must consist of plain floats");
+
+int partition_eliminate(const float *a, const float *b, const float *c,
+                        const float *d, size_t m, int first, int last,
+                        float *y, float *u, float *v, float *scratch,
+                        partition_chunk_t *chunk) {
+  if (a == NULL || b == NULL || c == NULL || d == NULL || y == NULL ||
+      u == NULL || v == NULL || scratch == NULL || chunk == NULL || m == 0) {
+    return -1; // Invalid parameter
+  }
+
+  // Rows 0 .. k - 1 form the interior system. Its coupling to X_{p-1}
+  // (a[0]) and to X_p (c[k - 1]) is moved to the right-hand sides of u and
+  // v, so a single Thomas sweep solves for y, u and v together.
+  const size_t k = m - 1;
+  float *cp = scratch;
+
+  for (size_t i = 0; i < k; i++) {
+    const float ai = i > 0 ? a[i] : 0.0f;
+    const float ci = i + 1 < k ? c[i] : 0.0f;
+    const float ru = i == 0 && !first ? -a[0] : 0.0f;
+    const float rv = i + 1 == k ? -c[i] : 0.0f;
+
+    if (i == 0) {
+      const float denom = b[0];
+      cp[0] = ci / denom;
+      y[0] = d[0] / denom;
+      u[0] = ru / denom;
+      v[0] = rv / denom;
+    } else {
+      const float denom = b[i] - ai * cp[i - 1];
+      cp[i] = ci / denom;
+      y[i] = (d[i] - ai * y[i - 1]) / denom;
+      u[i] = (ru - ai * u[i - 1]) / denom;
+      v[i] = (rv - ai * v[i - 1]) / denom;
+    }
+  }
+
+  for (size_t i = k; i-- > 1;) {
+    y[i - 1] -= cp[i - 1] * y[i];
+    u[i - 1] -= cp[i - 1] * u[i];
+    v[i - 1] -= cp[i - 1] * v[i];
+  }
+
+  if (k > 0) {
+    chunk->first[0] = y[0];
+    chunk->first[1] = u[0];
+    chunk->first[2] = v[0];
+    chunk->last[0] = y[k - 1];
+    chunk->last[1] = u[k - 1];
+    chunk->last[2] = v[k - 1];
+  } else {
+    chunk->first[0] = 0.0f;
+    chunk->first[1] = 0.0f;
+    chunk->first[2] = 1.0f;
+    chunk->last[0] = 0.0f;
+    chunk->last[1] = 1.0f;
+    chunk->last[2] = 0.0f;
+  }
+
+  chunk->row[0] = first && k == 0 ? 0.0f : a[k];
+  chunk->row[1] = b[k];
+  chunk->row[2] = last ? 0.0f : c[k];
+  chunk->row[3] = d[k];
+
+  return 0; // Success
+}
+
+int partition_reduce(const partition_chunk_t *chunks, size_t count, float *a,
+                     float *b, float *c, float *d) {
+  if (chunks == NULL || a == NULL || b == NULL || c == NULL || d == NULL) {
+    return -1; // Invalid parameter
+  }
+
+  for (size_t p = 0; p < count; p++) {
+    const partition_chunk_t *self = &chunks[p];
+    const float ra = self->row[0];
+    const float rc = p + 1 < count ? self->row[2] : 0.0f;
+
+    // The row after the interface row is the first row of the next chunk.
+    const float next_y = p + 1 < count ? chunks[p + 1].first[0] : 0.0f;
+    const float next_u = p + 1 < count ? chunks[p + 1].first[1] : 0.0f;
+    const float next_v = p + 1 < count ? chunks[p + 1].first[2] : 0.0f;
+
+    a[p] = ra * self->last[1];
+    b[p] = self->row[1] + ra * self->last[2] + rc * next_u;
+    c[p] = rc * next_v;
+    d[p] = self->row[3] - ra * self->last[0] - rc * next_y;
+  }
+
+  return 0; // Success
+}
+
+int partition_substitute(const float *y, const float *u, const float *v,
+                         size_t m, float x_prev, float x_last, float *x) {
+  if (y == NULL || u == NULL || v == NULL || x == NULL || m == 0) {
+    return -1; // Invalid parameter
+  }
+
+  for (size_t i = 0; i + 1 < m; i++) {
+    x[i] = y[i] + u[i] * x_prev + v[i] * x_last;
+  }
+  x[m - 1] = x_last;
+
+  return 0; // Success
+}
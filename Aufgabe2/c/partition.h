@@ -0,0 +1,120 @@
+/**
+ * @file partition.h
+ * @brief Building blocks of the partitioned tridiagonal solver.
+ *
+ * A system split into consecutive chunks can be solved chunk by chunk. The
+ * last row of every chunk is an interface row. The remaining rows of a chunk
+ * only couple to the interface value X_{p-1} of the previous chunk and X_p of
+ * its own, so after a local Thomas sweep over three right-hand sides their
+ * solution is
+ * \f[ x_i = y_i + u_i X_{p-1} + v_i X_p. \f]
+ * Inserting this into the interface rows yields a reduced tridiagonal system
+ * with one equation per chunk. Once it is solved, every chunk recovers its
+ * rows independently.
+ *
+ * The functions only work on plain arrays, so the same steps serve chunks
+ * held by different processes and chunks streamed from disk.
+ */
+
+#ifndef PARTITION_H
+#define PARTITION_H
+
+#include <stddef.h>
+
+/**
+ * @struct partition_chunk_s
+ * @brief Summary of one chunk needed to build the reduced system.
+ *
+ * @var partition_chunk_s::first
+ *   y, u and v of the first row of the chunk. For a chunk of one row, the
+ *   first row is the interface row itself, i.e. (0, 0, 1).
+ *
+ * @var partition_chunk_s::last
+ *   y, u and v of the last row before the interface row. For a chunk of one
+ *   row, this is the interface row of the previous chunk, i.e. (0, 1, 0).
+ *
+ * @var partition_chunk_s::row
+ *   a, b, c and d of the interface row.
+ *
+ * @note The struct consists of PARTITION_CHUNK_FLOATS floats, so an array of
+ *       summaries can be transferred as plain floats.
+ */
+struct partition_chunk_s {
+  float first[3];
+  float last[3];
+  float row[4];
+};
+
+/**
+ * @typedef partition_chunk_t
+ * @brief Convenience typedef for struct partition_chunk_s.
+ */
+typedef struct partition_chunk_s partition_chunk_t;
+
+/**
+ * @brief Number of floats in a partition_chunk_t.
+ */
+#define PARTITION_CHUNK_FLOATS 10
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Eliminate the rows of a chunk before its interface row.
+ *
+ * @param[in]  a, b, c, d  Coefficients and right-hand side of the m rows of
+ *                         the chunk. Not modified.
+ * @param[in]  m           Number of rows, at least 1.
+ * @param[in]  first       Non-zero for the first chunk of the system; its
+ *                         a[0] is then ignored.
+ * @param[in]  last        Non-zero for the last chunk of the system; its
+ *                         c[m - 1] is then ignored.
+ * @param[out] y, u, v     Arrays of m values receiving the local solution
+ *                         coefficients of rows 0 .. m - 2.
+ * @param[out] scratch     Array of m values used as work space.
+ * @param[out] chunk       Summary of the chunk.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int partition_eliminate(const float *a, const float *b, const float *c,
+                        const float *d, size_t m, int first, int last,
+                        float *y, float *u, float *v, float *scratch,
+                        partition_chunk_t *chunk);
+
+/**
+ * @brief Build the reduced system from the summaries of all chunks.
+ *
+ * Row p of the reduced system is the interface row of chunk p, with the
+ * neighbouring rows replaced by their local solutions.
+ *
+ * @param[in]  chunks      Summaries of count consecutive chunks.
+ * @param[in]  count       Number of chunks.
+ * @param[out] a, b, c, d  Arrays of count values receiving the reduced
+ *                         system.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int partition_reduce(const partition_chunk_t *chunks, size_t count, float *a,
+                     float *b, float *c, float *d);
+
+/**
+ * @brief Recover the solution of a chunk from the interface values.
+ *
+ * @param[in]  y, u, v  Local solution coefficients from partition_eliminate().
+ * @param[in]  m        Number of rows of the chunk.
+ * @param[in]  x_prev   Interface value of the previous chunk (ignored for
+ *                      the first chunk, whose u is zero).
+ * @param[in]  x_last   Interface value of this chunk.
+ * @param[out] x        Array of m values receiving the solution.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int partition_substitute(const float *y, const float *u, const float *v,
+                         size_t m, float x_prev, float x_last, float *x);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PARTITION_H
@@ -0,0 +1,224 @@
+#include "pcr_async.h"
+#include "sle.h"
+#include "util.h"
+
+#include <omp.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+struct pcr_future_s {
+  pcr_solver_fn solver;
+  triSLE_t *sle;
+  pcr_callback_fn callback;
+  void *user;
+
+  // Guarded by lock
+  pthread_mutex_t lock;
+  pthread_cond_t completed;
+  int done;
+  int detached; // released before completion, freed by the solver thread
+  int status;
+  timer start, end;
+
+  struct pcr_future_s *next; // guarded by the queue lock
+};
+
+struct pcr_queue_s {
+  pthread_t thread;
+  int nthreads;
+
+  // Guarded by lock
+  pthread_mutex_t lock;
+  pthread_cond_t submitted;
+  pcr_future_t *head;
+  pcr_future_t *tail;
+  int stopping;
+};
+
+static void future_free(pcr_future_t *future) {
+  pthread_cond_destroy(&future->completed);
+  pthread_mutex_destroy(&future->lock);
+  free(future);
+}
+
+static void *solver_thread(void *arg) {
+  pcr_queue_t *queue = (pcr_queue_t *)arg;
+
+  // The OpenMP team of this thread is created on the first solve and reused
+  // by all later ones.
+  if (queue->nthreads > 0) {
+    omp_set_num_threads(queue->nthreads);
+  }
+
+  for (;;) {
+    pthread_mutex_lock(&queue->lock);
+    while (queue->head == NULL && !queue->stopping) {
+      pthread_cond_wait(&queue->submitted, &queue->lock);
+    }
+    pcr_future_t *future = queue->head;
+    if (future == NULL) {
+      pthread_mutex_unlock(&queue->lock); // Stopping and drained
+      break;
+    }
+    queue->head = future->next;
+    if (queue->head == NULL) {
+      queue->tail = NULL;
+    }
+    pthread_mutex_unlock(&queue->lock);
+
+    timer start = {0, 0}, end = {0, 0};
+    const int status = future->solver(future->sle, &start, &end);
+    if (future->callback != NULL) {
+      future->callback(future->sle, status, future->user);
+    }
+
+    pthread_mutex_lock(&future->lock);
+    future->status = status;
+    future->start = start;
+    future->end = end;
+    future->done = 1;
+    const int detached = future->detached;
+    pthread_cond_broadcast(&future->completed);
+    pthread_mutex_unlock(&future->lock);
+
+    if (detached) {
+      future_free(future);
+    }
+  }
+
+  return NULL;
+}
+
+int pcr_queue_create(pcr_queue_t **queue, int nthreads) {
+  if (queue == NULL || nthreads < 0) {
+    return -1; // Invalid parameter
+  }
+
+  pcr_queue_t *q = (pcr_queue_t *)calloc(1, sizeof(pcr_queue_t));
+  if (q == NULL) {
+    return -1; // Memory allocation failed
+  }
+
+  q->nthreads = nthreads;
+  pthread_mutex_init(&q->lock, NULL);
+  pthread_cond_init(&q->submitted, NULL);
+
+  if (pthread_create(&q->thread, NULL, solver_thread, q) != 0) {
+    pthread_cond_destroy(&q->submitted);
+    pthread_mutex_destroy(&q->lock);
+    free(q);
+    return -1; // Failed to start the solver thread
+  }
+
+  *queue = q;
+  return 0; // Success
+}
+
+int pcr_queue_destroy(pcr_queue_t *queue) {
+  if (queue == NULL) {
+    return -1; // Invalid parameter
+  }
+
+  pthread_mutex_lock(&queue->lock);
+  queue->stopping = 1;
+  pthread_cond_signal(&queue->submitted);
+  pthread_mutex_unlock(&queue->lock);
+
+  pthread_join(queue->thread, NULL);
+
+  pthread_cond_destroy(&queue->submitted);
+  pthread_mutex_destroy(&queue->lock);
+  free(queue);
+
+  return 0; // Success
+}
+
+int pcr_submit(pcr_queue_t *queue, pcr_solver_fn solver, triSLE_t *sle,
+               pcr_callback_fn callback, void *user, pcr_future_t **future) {
+  if (queue == NULL || solver == NULL || sle == NULL) {
+    return -1; // Invalid parameter
+  }
+
+  pcr_future_t *f = (pcr_future_t *)calloc(1, sizeof(pcr_future_t));
+  if (f == NULL) {
+    return -1; // Memory allocation failed
+  }
+
+  f->solver = solver;
+  f->sle = sle;
+  f->callback = callback;
+  f->user = user;
+  f->detached = future == NULL;
+  pthread_mutex_init(&f->lock, NULL);
+  pthread_cond_init(&f->completed, NULL);
+
+  pthread_mutex_lock(&queue->lock);
+  if (queue->stopping) {
+    pthread_mutex_unlock(&queue->lock);
+    future_free(f);
+    return -1; // Queue is being destroyed
+  }
+  if (queue->tail != NULL) {
+    queue->tail->next = f;
+  } else {
+    queue->head = f;
+  }
+  queue->tail = f;
+  pthread_cond_signal(&queue->submitted);
+  pthread_mutex_unlock(&queue->lock);
+
+  if (future != NULL) {
+    *future = f;
+  }
+  return 0; // Success
+}
+
+int pcr_future_poll(pcr_future_t *future) {
+  if (future == NULL) {
+    return -1; // Invalid parameter
+  }
+
+  pthread_mutex_lock(&future->lock);
+  const int done = future->done;
+  pthread_mutex_unlock(&future->lock);
+
+  return done;
+}
+
+int pcr_future_wait(pcr_future_t *future, timer *start, timer *end) {
+  if (future == NULL) {
+    return -1; // Invalid parameter
+  }
+
+  pthread_mutex_lock(&future->lock);
+  while (!future->done) {
+    pthread_cond_wait(&future->completed, &future->lock);
+  }
+  const int status = future->status;
+  if (start != NULL) {
+    *start = future->start;
+  }
+  if (end != NULL) {
+    *end = future->end;
+  }
+  pthread_mutex_unlock(&future->lock);
+
+  return status;
+}
+
+int pcr_future_release(pcr_future_t *future) {
+  if (future == NULL) {
+    return -1; // Invalid parameter
+  }
+
+  pthread_mutex_lock(&future->lock);
+  const int done = future->done;
+  future->detached = !done;
+  pthread_mutex_unlock(&future->lock);
+
+  if (done) {
+    future_free(future);
+  }
+  return 0; // Success
+}
@@ -0,0 +1,140 @@
+/**
+ * @file pcr_async.h
+ * @brief Asynchronous solves on a persistent solver thread.
+ *
+ * A queue owns one solver thread that runs the submitted solves one after
+ * the other, each with its own OpenMP team, while the submitting thread
+ * continues, e.g. assembling the next system. Every submission returns a
+ * future that can be polled or waited on, and can carry a callback that
+ * runs on the solver thread once the solve finished.
+ *
+ * Pipelining assembly, solve and post-processing only needs two (or more)
+ * systems used in turn: while system k is solved, system k + 1 is filled.
+ * Before a system is filled again, the future of its previous solve must
+ * have completed.
+ */
+
+#ifndef PCR_ASYNC_H
+#define PCR_ASYNC_H
+
+#include "sle.h"
+#include "util.h"
+
+/**
+ * @typedef pcr_solver_fn
+ * @brief A solver with the signature of pcr(), e.g. pcr, thomas,
+ * pcr_periodic or pcr_gpu.
+ */
+typedef int (*pcr_solver_fn)(triSLE_t *sle, timer *start, timer *end);
+
+/**
+ * @typedef pcr_callback_fn
+ * @brief Called on the solver thread after a solve.
+ *
+ * @param[in] sle     The solved system.
+ * @param[in] status  Return value of the solver.
+ * @param[in] user    Pointer given to pcr_submit().
+ */
+typedef void (*pcr_callback_fn)(triSLE_t *sle, int status, void *user);
+
+/**
+ * @typedef pcr_queue_t
+ * @brief Opaque queue of solves with its solver thread.
+ */
+typedef struct pcr_queue_s pcr_queue_t;
+
+/**
+ * @typedef pcr_future_t
+ * @brief Opaque handle of one submitted solve.
+ */
+typedef struct pcr_future_s pcr_future_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Create a queue and start its solver thread.
+ *
+ * @param[out] queue     Pointer to pcr_queue_t pointer where the new queue
+ *                       will be stored. Must not be NULL.
+ * @param[in]  nthreads  Number of OpenMP threads of the solves, or 0 for the
+ *                       default of the OpenMP runtime.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ *
+ * @note The caller is responsible for freeing the queue using
+ *       pcr_queue_destroy().
+ */
+int pcr_queue_create(pcr_queue_t **queue, int nthreads);
+
+/**
+ * @brief Finish all submitted solves, stop the solver thread and free the
+ * queue.
+ *
+ * @param[in] queue  Pointer to the queue to destroy.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ *
+ * @note Futures that were not released stay valid and must still be
+ *       released with pcr_future_release().
+ */
+int pcr_queue_destroy(pcr_queue_t *queue);
+
+/**
+ * @brief Submit a solve to the queue.
+ *
+ * Solves are run in the order of submission. The system must not be
+ * accessed by the caller until the future has completed.
+ *
+ * @param[in]  queue     The queue.
+ * @param[in]  solver    Solver to run, e.g. pcr.
+ * @param[in]  sle       System to solve.
+ * @param[in]  callback  Called on the solver thread after the solve, before
+ *                       the future completes, or NULL.
+ * @param[in]  user      Passed to the callback.
+ * @param[out] future    Receives the handle of the solve, or NULL if the
+ *                       caller does not wait for it.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int pcr_submit(pcr_queue_t *queue, pcr_solver_fn solver, triSLE_t *sle,
+               pcr_callback_fn callback, void *user, pcr_future_t **future);
+
+/**
+ * @brief Check whether a solve has completed, without blocking.
+ *
+ * @param[in] future  Handle from pcr_submit().
+ *
+ * @return 1 if the solve has completed, 0 if it is pending, negative on
+ *         error.
+ */
+int pcr_future_poll(pcr_future_t *future);
+
+/**
+ * @brief Wait until a solve has completed.
+ *
+ * @param[in]  future  Handle from pcr_submit().
+ * @param[out] start   Receives the start time of the solve, or NULL.
+ * @param[out] end     Receives the end time of the solve, or NULL.
+ *
+ * @return Return value of the solver, non-zero on failure.
+ */
+int pcr_future_wait(pcr_future_t *future, timer *start, timer *end);
+
+/**
+ * @brief Release a handle.
+ *
+ * A pending solve still runs to completion; its handle is freed afterwards.
+ *
+ * @param[in] future  Handle from pcr_submit().
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int pcr_future_release(pcr_future_t *future);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PCR_ASYNC_H
@@ -0,0 +1,111 @@
+#include "batch.h"
+#include "pcr_kernel.h"
+#include "pcr_simd.h"
+#include "solver.h"
+#include "util.h"
+
+#include <omp.h>
+#include <stddef.h>
+
+// Solve rows [0, n) of one system on the calling thread. The level loop swaps
+// local pointers only, so the batch diagonals and the scratch diagonals never
+// change owners. On return, one of the two buffer sets holds the last level.
+static inline void solve_serial(pcr_update_range_fn kernel, float *sa,
+                                float *sb, float *sc, float *sd, float *ta,
+                                float *tb, float *tc, float *td,
+                                float *restrict x, int n) {
+  const size_t total_levels = pcr_total_levels((size_t)n);
+
+  for (size_t level = 0; level < total_levels; level++) {
+    const int stride = 1 << level;
+    kernel(sa, sb, sc, sd, ta, tb, tc, td, n, stride, 0, n);
+
+    float *swap;
+    swap = sa, sa = ta, ta = swap;
+    swap = sb, sb = tb, tb = swap;
+    swap = sc, sc = tc, tc = swap;
+    swap = sd, sd = td, td = swap;
+  }
+
+  for (int i = 0; i < n; i++) {
+    x[i] = sd[i] / sb[i];
+  }
+}
+
+// Solve one system with all threads of the enclosing parallel region. Must be
+// called by every thread of the team; each thread reduces its static range and
+// swaps its own copy of the pointers after the barrier.
+static inline void solve_shared(pcr_update_range_fn kernel, float *sa,
+                                float *sb, float *sc, float *sd, float *ta,
+                                float *tb, float *tc, float *td,
+                                float *restrict x, int n) {
+  const size_t total_levels = pcr_total_levels((size_t)n);
+
+  int lo, hi;
+  pcr_thread_range(n, omp_get_thread_num(), omp_get_num_threads(), &lo, &hi);
+
+  for (size_t level = 0; level < total_levels; level++) {
+    const int stride = 1 << level;
+    kernel(sa, sb, sc, sd, ta, tb, tc, td, n, stride, lo, hi);
+#pragma omp barrier
+
+    float *swap;
+    swap = sa, sa = ta, ta = swap;
+    swap = sb, sb = tb, tb = swap;
+    swap = sc, sc = tc, tc = swap;
+    swap = sd, sd = td, td = swap;
+  }
+
+#pragma omp for schedule(static)
+  for (int i = 0; i < n; i++) {
+    x[i] = sd[i] / sb[i];
+  }
+}
+
+int pcr_batched(triSLE_batch_t *batch, timer *start, timer *end) {
+  if (batch == NULL) {
+    return -1;
+  }
+
+  TIME_GET(*start);
+
+  const int count = (int)batch->count;
+  const size_t *offsets = batch->offsets;
+
+  float *a = batch->a->data;
+  float *b = batch->b->data;
+  float *c = batch->c->data;
+  float *d = batch->d->data;
+  float *x = batch->x->data;
+  float *ta = batch->tmp[0]->data;
+  float *tb = batch->tmp[1]->data;
+  float *tc = batch->tmp[2]->data;
+  float *td = batch->tmp[3]->data;
+
+  const pcr_update_range_fn kernel = pcr_update_range_select();
+
+  // A single parallel region for the whole batch. With enough systems to keep
+  // every thread busy, each system is solved by one thread; otherwise all
+  // threads cooperate on one system after the other.
+#pragma omp parallel
+  {
+    if (count >= omp_get_num_threads()) {
+#pragma omp for schedule(dynamic, 1)
+      for (int k = 0; k < count; k++) {
+        const size_t o = offsets[k];
+        solve_serial(kernel, a + o, b + o, c + o, d + o, ta + o, tb + o,
+                     tc + o, td + o, x + o, (int)(offsets[k + 1] - o));
+      }
+    } else {
+      for (int k = 0; k < count; k++) {
+        const size_t o = offsets[k];
+        solve_shared(kernel, a + o, b + o, c + o, d + o, ta + o, tb + o,
+                     tc + o, td + o, x + o, (int)(offsets[k + 1] - o));
+      }
+    }
+  }
+
+  TIME_GET(*end);
+
+  return 0;
+}
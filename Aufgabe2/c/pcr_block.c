@@ -0,0 +1,306 @@
+#include "pcr_kernel.h"
+#include "sle_block.h"
+#include "solver.h"
+#include "util.h"
+
+#include <math.h>
+#include <omp.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+// The block helpers take the block size as a parameter and are force-inlined
+// into one set of row functions per block size, where m is a constant and
+// the small loops are unrolled.
+#if defined(__GNUC__)
+#define BLOCK_INLINE static inline __attribute__((always_inline))
+#else
+#define BLOCK_INLINE static inline
+#endif
+
+#define BLOCK_FLOATS (TRISLE_BLOCK_MAX * TRISLE_BLOCK_MAX)
+
+// out = inverse of the m x m block in, by Gauss-Jordan elimination with
+// partial pivoting. A zero pivot is replaced by EPSILON, as in the scalar
+// decoupling coefficients.
+BLOCK_INLINE void block_inverse(const float *restrict in, float *restrict out,
+                                int m) {
+  float w[BLOCK_FLOATS];
+
+  for (int r = 0; r < m; r++) {
+    for (int k = 0; k < m; k++) {
+      w[r * m + k] = in[r * m + k];
+      out[r * m + k] = r == k ? 1.0f : 0.0f;
+    }
+  }
+
+  for (int col = 0; col < m; col++) {
+    int pivot = col;
+    for (int r = col + 1; r < m; r++) {
+      if (fabsf(w[r * m + col]) > fabsf(w[pivot * m + col])) {
+        pivot = r;
+      }
+    }
+    if (pivot != col) {
+      for (int k = 0; k < m; k++) {
+        float swap = w[col * m + k];
+        w[col * m + k] = w[pivot * m + k];
+        w[pivot * m + k] = swap;
+        swap = out[col * m + k];
+        out[col * m + k] = out[pivot * m + k];
+        out[pivot * m + k] = swap;
+      }
+    }
+
+    const float p = w[col * m + col];
+    const float scale = 1.0f / (p == 0.0f ? (float)EPSILON : p);
+    for (int k = 0; k < m; k++) {
+      w[col * m + k] *= scale;
+      out[col * m + k] *= scale;
+    }
+
+    for (int r = 0; r < m; r++) {
+      if (r == col) {
+        continue;
+      }
+      const float f = w[r * m + col];
+      for (int k = 0; k < m; k++) {
+        w[r * m + k] -= f * w[col * m + k];
+        out[r * m + k] -= f * out[col * m + k];
+      }
+    }
+  }
+}
+
+// out = -(x y) for m x m blocks
+BLOCK_INLINE void block_mul_neg(const float *restrict x,
+                                const float *restrict y, float *restrict out,
+                                int m) {
+  for (int r = 0; r < m; r++) {
+    for (int k = 0; k < m; k++) {
+      float sum = 0.0f;
+      for (int j = 0; j < m; j++) {
+        sum += x[r * m + j] * y[j * m + k];
+      }
+      out[r * m + k] = -sum;
+    }
+  }
+}
+
+// out (+)= x y for m x m blocks
+BLOCK_INLINE void block_mul_acc(const float *restrict x,
+                                const float *restrict y, float *restrict out,
+                                int m, int accumulate) {
+  for (int r = 0; r < m; r++) {
+    for (int k = 0; k < m; k++) {
+      float sum = accumulate ? out[r * m + k] : 0.0f;
+      for (int j = 0; j < m; j++) {
+        sum += x[r * m + j] * y[j * m + k];
+      }
+      out[r * m + k] = sum;
+    }
+  }
+}
+
+// out (+)= x v for an m x m block x and a vector v
+BLOCK_INLINE void block_mul_vec_acc(const float *restrict x,
+                                    const float *restrict v,
+                                    float *restrict out, int m,
+                                    int accumulate) {
+  for (int r = 0; r < m; r++) {
+    float sum = accumulate ? out[r] : 0.0f;
+    for (int j = 0; j < m; j++) {
+      sum += x[r * m + j] * v[j];
+    }
+    out[r] = sum;
+  }
+}
+
+// Invert the main diagonal blocks of rows [lo, hi). The inverses of a level
+// are formed once and read by both neighbours of every row.
+BLOCK_INLINE void invert_rows(const float *sb, float *inv, int m, int lo,
+                              int hi) {
+  const int mm = m * m;
+  for (int i = lo; i < hi; i++) {
+    block_inverse(sb + (size_t)i * mm, inv + (size_t)i * mm, m);
+  }
+}
+
+// Block version of pcr_update_row() for the rows [lo, hi): with
+// alpha = -A_i B_l^-1 and gamma = -C_i B_r^-1 of the neighbours
+// l = i - stride and r = i + stride, row i becomes
+// (alpha A_l, B_i + alpha C_l + gamma A_r, gamma C_r | d_i + alpha d_l +
+// gamma d_r). Missing neighbours contribute nothing.
+BLOCK_INLINE void update_rows(const float *sa, const float *sb,
+                              const float *sc, const float *sd,
+                              const float *inv, float *ta, float *tb,
+                              float *tc, float *td, int n, int m, int stride,
+                              int lo, int hi) {
+  const size_t mm = (size_t)m * m;
+
+  for (int i = lo; i < hi; i++) {
+    const int l = i - stride;
+    const int r = i + stride;
+    float coeff[BLOCK_FLOATS];
+
+    for (size_t k = 0; k < mm; k++) {
+      tb[i * mm + k] = sb[i * mm + k];
+    }
+    for (int k = 0; k < m; k++) {
+      td[(size_t)i * m + k] = sd[(size_t)i * m + k];
+    }
+
+    if (l >= 0) {
+      block_mul_neg(sa + i * mm, inv + l * mm, coeff, m);
+      block_mul_acc(coeff, sa + l * mm, ta + i * mm, m, 0);
+      block_mul_acc(coeff, sc + l * mm, tb + i * mm, m, 1);
+      block_mul_vec_acc(coeff, sd + (size_t)l * m, td + (size_t)i * m, m, 1);
+    } else {
+      for (size_t k = 0; k < mm; k++) {
+        ta[i * mm + k] = 0.0f;
+      }
+    }
+
+    if (r < n) {
+      block_mul_neg(sc + i * mm, inv + r * mm, coeff, m);
+      block_mul_acc(coeff, sc + r * mm, tc + i * mm, m, 0);
+      block_mul_acc(coeff, sa + r * mm, tb + i * mm, m, 1);
+      block_mul_vec_acc(coeff, sd + (size_t)r * m, td + (size_t)i * m, m, 1);
+    } else {
+      for (size_t k = 0; k < mm; k++) {
+        tc[i * mm + k] = 0.0f;
+      }
+    }
+  }
+}
+
+// x_i = B_i^-1 d_i for the decoupled rows [lo, hi)
+BLOCK_INLINE void solve_rows(const float *sb, const float *sd, float *x,
+                             int m, int lo, int hi) {
+  const size_t mm = (size_t)m * m;
+  float inv[BLOCK_FLOATS];
+
+  for (int i = lo; i < hi; i++) {
+    block_inverse(sb + i * mm, inv, m);
+    block_mul_vec_acc(inv, sd + (size_t)i * m, x + (size_t)i * m, m, 0);
+  }
+}
+
+typedef struct {
+  void (*invert)(const float *sb, float *inv, int lo, int hi);
+  void (*update)(const float *sa, const float *sb, const float *sc,
+                 const float *sd, const float *inv, float *ta, float *tb,
+                 float *tc, float *td, int n, int stride, int lo, int hi);
+  void (*solve)(const float *sb, const float *sd, float *x, int lo, int hi);
+} block_kernels_t;
+
+#define BLOCK_KERNELS(M)                                                       \
+  static void invert_##M(const float *sb, float *inv, int lo, int hi) {        \
+    invert_rows(sb, inv, M, lo, hi);                                           \
+  }                                                                            \
+  static void update_##M(const float *sa, const float *sb, const float *sc,    \
+                         const float *sd, const float *inv, float *ta,         \
+                         float *tb, float *tc, float *td, int n, int stride,   \
+                         int lo, int hi) {                                     \
+    update_rows(sa, sb, sc, sd, inv, ta, tb, tc, td, n, M, stride, lo, hi);    \
+  }                                                                            \
+  static void solve_##M(const float *sb, const float *sd, float *x, int lo,    \
+                        int hi) {                                              \
+    solve_rows(sb, sd, x, M, lo, hi);                                          \
+  }
+
+BLOCK_KERNELS(1)
+BLOCK_KERNELS(2)
+BLOCK_KERNELS(3)
+BLOCK_KERNELS(4)
+BLOCK_KERNELS(5)
+BLOCK_KERNELS(6)
+BLOCK_KERNELS(7)
+BLOCK_KERNELS(8)
+
+#undef BLOCK_KERNELS
+
+static const block_kernels_t block_kernels[TRISLE_BLOCK_MAX + 1] = {
+    {NULL, NULL, NULL},
+    {invert_1, update_1, solve_1},
+    {invert_2, update_2, solve_2},
+    {invert_3, update_3, solve_3},
+    {invert_4, update_4, solve_4},
+    {invert_5, update_5, solve_5},
+    {invert_6, update_6, solve_6},
+    {invert_7, update_7, solve_7},
+    {invert_8, update_8, solve_8},
+};
+
+int pcr_block(triSLE_block_t *sle, timer *start, timer *end) {
+  if (sle == NULL || sle->m < 1 || sle->m > TRISLE_BLOCK_MAX) {
+    return -1;
+  }
+  const size_t n = sle->n;
+  if (n == 0) {
+    return 0; // Nothing to do
+  }
+
+  TIME_GET(*start);
+
+  const size_t blocks = n * sle->m * sle->m;
+  const size_t values = n * sle->m;
+
+  // Second buffer set for a, b, c and d, and the inverses of one level
+  float *tmp_a = (float *)malloc(blocks * sizeof(float));
+  float *tmp_b = (float *)malloc(blocks * sizeof(float));
+  float *tmp_c = (float *)malloc(blocks * sizeof(float));
+  float *tmp_d = (float *)malloc(values * sizeof(float));
+  float *inv = (float *)malloc(blocks * sizeof(float));
+
+  if (tmp_a == NULL || tmp_b == NULL || tmp_c == NULL || tmp_d == NULL ||
+      inv == NULL) {
+    free(tmp_a);
+    free(tmp_b);
+    free(tmp_c);
+    free(tmp_d);
+    free(inv);
+    return -1; // Memory allocation failure
+  }
+
+  const block_kernels_t *kernels = &block_kernels[sle->m];
+  const size_t total_levels = pcr_total_levels(n);
+  float *x = sle->x->data;
+
+  float *sa = sle->a->data, *sb = sle->b->data;
+  float *sc = sle->c->data, *sd = sle->d->data;
+  float *ta = tmp_a, *tb = tmp_b, *tc = tmp_c, *td = tmp_d;
+
+#pragma omp parallel firstprivate(sa, sb, sc, sd, ta, tb, tc, td)
+  {
+    int lo, hi;
+    pcr_thread_range((int)n, omp_get_thread_num(), omp_get_num_threads(), &lo,
+                     &hi);
+
+    for (size_t level = 0; level < total_levels; level++) {
+      kernels->invert(sb, inv, lo, hi);
+#pragma omp barrier
+      kernels->update(sa, sb, sc, sd, inv, ta, tb, tc, td, (int)n,
+                      1 << level, lo, hi);
+#pragma omp barrier
+
+      float *swap;
+      swap = sa, sa = ta, ta = swap;
+      swap = sb, sb = tb, tb = swap;
+      swap = sc, sc = tc, tc = swap;
+      swap = sd, sd = td, td = swap;
+    }
+
+    // Every block row is decoupled, so each thread solves its own rows
+    kernels->solve(sb, sd, x, lo, hi);
+  }
+
+  TIME_GET(*end);
+
+  free(tmp_a);
+  free(tmp_b);
+  free(tmp_c);
+  free(tmp_d);
+  free(inv);
+
+  return 0;
+}
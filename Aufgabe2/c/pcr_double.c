@@ -0,0 +1,158 @@
+#include "diagonal.h"
+#include "pcr_kernel.h"
+#include "sle.h"
+#include "solver.h"
+#include "util.h"
+#include "workspace.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+
+int pcr_d(triSLE_d_t *sle, timer *start, timer *end) {
+  if (sle == NULL) {
+    return -1;
+  }
+  size_t n = sle->b->n;
+  if (n == 0) {
+    return 0; // Nothing to do
+  }
+
+  TIME_GET(*start);
+
+  size_t total_levels = pcr_total_levels(n);
+
+  double *a_data_tmp = (double *)malloc(n * sizeof(double));
+  double *b_data_tmp = (double *)malloc(n * sizeof(double));
+  double *c_data_tmp = (double *)malloc(n * sizeof(double));
+  double *d_data_tmp = (double *)malloc(n * sizeof(double));
+
+  if (a_data_tmp == NULL || b_data_tmp == NULL || c_data_tmp == NULL ||
+      d_data_tmp == NULL) {
+    free(a_data_tmp);
+    free(b_data_tmp);
+    free(c_data_tmp);
+    free(d_data_tmp);
+    return -1; // Memory allocation failure
+  }
+
+  // Only local pointers are swapped, and the last level is fused with
+  // x = d / b, so nothing has to be copied back.
+  double *sa = sle->a->data, *ta = a_data_tmp;
+  double *sb = sle->b->data, *tb = b_data_tmp;
+  double *sc = sle->c->data, *tc = c_data_tmp;
+  double *sd = sle->d->data, *td = d_data_tmp;
+  double *x = sle->x->data;
+
+  if (total_levels == 0) {
+    x[0] = sd[0] / sb[0];
+  }
+
+  for (size_t level = 0; level + 1 < total_levels; level++) {
+    const int stride = 1 << level;
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < (int)n; i++) {
+      pcr_update_row_d(sa, sb, sc, sd, ta, tb, tc, td, (int)n, stride, i);
+    }
+
+    double *swap;
+    swap = sa, sa = ta, ta = swap;
+    swap = sb, sb = tb, tb = swap;
+    swap = sc, sc = tc, tc = swap;
+    swap = sd, sd = td, td = swap;
+  }
+
+  if (total_levels > 0) {
+    const int stride = 1 << (total_levels - 1);
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < (int)n; i++) {
+      pcr_solve_row_d(sa, sb, sc, sd, x, (int)n, stride, i);
+    }
+  }
+
+  TIME_GET(*end);
+
+  free(a_data_tmp);
+  free(b_data_tmp);
+  free(c_data_tmp);
+  free(d_data_tmp);
+
+  return 0;
+}
+
+// Round the coefficients of src to single precision. The right-hand side is
+// taken from rhs.
+static void round_system(triSLE_t *dest, triSLE_d_t *src, const double *rhs) {
+#pragma omp parallel for schedule(static)
+  for (size_t i = 0; i < src->b->n; i++) {
+    dest->a->data[i] = (float)src->a->data[i];
+    dest->b->data[i] = (float)src->b->data[i];
+    dest->c->data[i] = (float)src->c->data[i];
+    dest->d->data[i] = (float)rhs[i];
+  }
+}
+
+int pcr_mixed(triSLE_d_t *sle, int iterations, timer *start, timer *end) {
+  if (sle == NULL || iterations < 0) {
+    return -1;
+  }
+  size_t n = sle->b->n;
+  if (n == 0) {
+    return 0; // Nothing to do
+  }
+
+  triSLE_t *single = NULL;
+  pcr_workspace_t *ws = NULL;
+  double *residual = (double *)malloc(n * sizeof(double));
+
+  if (residual == NULL || triSLE_create(&single, (int)n) != 0 ||
+      pcr_workspace_create(&ws, (int)n) != 0) {
+    free(residual);
+    if (single != NULL) {
+      triSLE_destroy(single);
+    }
+    return -1; // Memory allocation failure
+  }
+
+  timer level_start, level_end;
+  int ret = 0;
+
+  TIME_GET(*start);
+
+  round_system(single, sle, sle->d->data);
+  if (pcr_ws(single, ws, &level_start, &level_end) != 0) {
+    ret = -1; // Single precision solve failed
+    goto cleanup;
+  }
+
+  double *x = sle->x->data;
+#pragma omp parallel for schedule(static)
+  for (size_t i = 0; i < n; i++) {
+    x[i] = single->x->data[i];
+  }
+
+  // Iterative refinement: solve A e = d - A x in single precision and
+  // correct x in double precision. pcr_ws() overwrites the single precision
+  // coefficients, so they are rounded again for every step.
+  for (int it = 0; it < iterations; it++) {
+    triSLE_d_residual(sle, sle, residual);
+    round_system(single, sle, residual);
+    if (pcr_ws(single, ws, &level_start, &level_end) != 0) {
+      ret = -1; // Single precision solve failed
+      goto cleanup;
+    }
+
+#pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < n; i++) {
+      x[i] += single->x->data[i];
+    }
+  }
+
+  TIME_GET(*end);
+
+cleanup:
+  pcr_workspace_destroy(ws);
+  triSLE_destroy(single);
+  free(residual);
+
+  return ret;
+}
@@ -0,0 +1,265 @@
+#include "factor.h"
+#include "pcr_kernel.h"
+#include "sle.h"
+#include "solver.h"
+#include "util.h"
+#include "workspace.h"
+
+#include <omp.h>
+#include <stddef.h>
+
+// Rows per work item of the vectorized loops
+#define FACTOR_BLOCK 1024
+
+// Reduce the matrix part of row i and record the decoupling coefficients.
+// A missing neighbour gets the coefficient 0, so the right-hand side update
+// can read any valid row in its place.
+static inline void factor_row(const float *restrict sa,
+                              const float *restrict sb,
+                              const float *restrict sc, float *restrict ta,
+                              float *restrict tb, float *restrict tc,
+                              float *restrict alpha, float *restrict gamma,
+                              int n, int stride, int i) {
+  const int iLeft = i - stride;
+  const int iRight = i + stride;
+
+  const float al =
+      iLeft < 0 ? 0.0f : compute_decoupling_coeffs(sb[iLeft], sa[i]);
+  const float ga =
+      iRight >= n ? 0.0f : compute_decoupling_coeffs(sb[iRight], sc[i]);
+
+  alpha[i] = al;
+  gamma[i] = ga;
+
+  tb[i] = sb[i] + (iLeft < 0 ? 0.0f : al * sc[iLeft]) +
+          (iRight >= n ? 0.0f : ga * sa[iRight]);
+  if (ta != NULL) {
+    ta[i] = iLeft < 0 ? 0.0f : al * sa[iLeft];
+    tc[i] = iRight >= n ? 0.0f : ga * sc[iRight];
+  }
+}
+
+// factor_row() for rows [lo, hi), which all have both neighbours. The loop is
+// branch-free and vectorizes; clones for wider vector units are selected at
+// load time on x86. ta and tc are not written for the last level.
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__)
+__attribute__((target_clones("avx512f", "avx2", "default")))
+#endif
+static void factor_rows(const float *restrict sa, const float *restrict sb,
+                        const float *restrict sc, float *restrict ta,
+                        float *restrict tb, float *restrict tc,
+                        float *restrict alpha, float *restrict gamma,
+                        int stride, int lo, int hi, int last) {
+  const float eps = (float)EPSILON;
+
+#pragma omp simd
+  for (int i = lo; i < hi; i++) {
+    const float b_l = sb[i - stride];
+    const float b_r = sb[i + stride];
+    const float al = -sa[i] / (b_l == 0.0f ? eps : b_l);
+    const float ga = -sc[i] / (b_r == 0.0f ? eps : b_r);
+
+    alpha[i] = al;
+    gamma[i] = ga;
+    tb[i] = sb[i] + al * sc[i - stride] + ga * sa[i + stride];
+    if (!last) {
+      ta[i] = al * sa[i - stride];
+      tc[i] = ga * sc[i + stride];
+    }
+  }
+}
+
+int pcr_factorize(triSLE_t *sle, pcr_workspace_t *ws, pcr_factor_t *factor,
+                  timer *start, timer *end) {
+  if (sle == NULL || ws == NULL || factor == NULL) {
+    return -1;
+  }
+  size_t n = sle->b->n;
+  if (n != factor->n || n > ws->max_n) {
+    return -1; // Size mismatch
+  }
+  if (n == 0) {
+    return 0; // Nothing to do
+  }
+
+  TIME_GET(*start);
+
+  const size_t levels = factor->levels;
+
+  float *sa = sle->a->data;
+  float *sb = sle->b->data;
+  float *sc = sle->c->data;
+  float *ta = ws->tmp[0]->data;
+  float *tb = ws->tmp[1]->data;
+  float *tc = ws->tmp[2]->data;
+  float *b_last = factor->b->data;
+
+  if (levels == 0) {
+    b_last[0] = sb[0];
+  }
+
+#pragma omp parallel
+  {
+    float *pa = sa, *pb = sb, *pc = sc;
+    float *qa = ta, *qb = tb, *qc = tc;
+
+    for (size_t level = 0; level < levels; level++) {
+      const int stride = 1 << level;
+      const int last = level + 1 == levels;
+      float *alpha = factor->alpha[level]->data;
+      float *gamma = factor->gamma[level]->data;
+
+      // The few rows without both neighbours take the generic path. The last
+      // level only needs the final main diagonal.
+      const int lo = stride < (int)n ? stride : (int)n;
+      const int hi = (int)n - stride > lo ? (int)n - stride : lo;
+
+#pragma omp for schedule(static) nowait
+      for (int i = 0; i < lo; i++) {
+        factor_row(pa, pb, pc, last ? NULL : qa, qb, qc, alpha, gamma, (int)n,
+                   stride, i);
+      }
+
+#pragma omp for schedule(static) nowait
+      for (int i = hi; i < (int)n; i++) {
+        factor_row(pa, pb, pc, last ? NULL : qa, qb, qc, alpha, gamma, (int)n,
+                   stride, i);
+      }
+
+      const int blocks = (hi - lo + FACTOR_BLOCK - 1) / FACTOR_BLOCK;
+#pragma omp for schedule(static)
+      for (int blk = 0; blk < blocks; blk++) {
+        const int i0 = lo + blk * FACTOR_BLOCK;
+        const int i1 = i0 + FACTOR_BLOCK < hi ? i0 + FACTOR_BLOCK : hi;
+        factor_rows(pa, pb, pc, qa, qb, qc, alpha, gamma, stride, i0, i1,
+                    last);
+      }
+
+      if (last) {
+#pragma omp for schedule(static)
+        for (int i = 0; i < (int)n; i++) {
+          b_last[i] = qb[i];
+        }
+      }
+
+      float *swap;
+      swap = pa, pa = qa, qa = swap;
+      swap = pb, pb = qb, qb = swap;
+      swap = pc, pc = qc, qc = swap;
+    }
+  }
+
+  TIME_GET(*end);
+
+  return 0;
+}
+
+// Apply one level to the k right-hand sides of rows [i0, i1): two
+// multiply-adds per value. Cloned like factor_rows().
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__)
+__attribute__((target_clones("avx512f", "avx2", "default")))
+#endif
+static void update_rhs(const float *restrict alpha,
+                       const float *restrict gamma, const float *restrict sd,
+                       float *restrict td, int n, int k, int stride, int i0,
+                       int i1) {
+  for (int i = i0; i < i1; i++) {
+    const int iLeft = i - stride >= 0 ? i - stride : i;
+    const int iRight = i + stride < n ? i + stride : i;
+    const float al = alpha[i];
+    const float ga = gamma[i];
+
+    const float *restrict di = sd + (size_t)i * k;
+    const float *restrict dl = sd + (size_t)iLeft * k;
+    const float *restrict dr = sd + (size_t)iRight * k;
+    float *restrict out = td + (size_t)i * k;
+
+#pragma omp simd
+    for (int j = 0; j < k; j++) {
+      out[j] = di[j] + al * dl[j] + ga * dr[j];
+    }
+  }
+}
+
+// As update_rhs() for the last level, which writes x = d' / b'. Kept apart
+// so that only this level divides.
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__)
+__attribute__((target_clones("avx512f", "avx2", "default")))
+#endif
+static void solve_rhs(const float *restrict alpha, const float *restrict gamma,
+                      const float *restrict b_last, const float *restrict sd,
+                      float *restrict x, int n, int k, int stride, int i0,
+                      int i1) {
+  for (int i = i0; i < i1; i++) {
+    const int iLeft = i - stride >= 0 ? i - stride : i;
+    const int iRight = i + stride < n ? i + stride : i;
+    const float al = alpha[i];
+    const float ga = gamma[i];
+    const float b = b_last[i];
+
+    const float *restrict di = sd + (size_t)i * k;
+    const float *restrict dl = sd + (size_t)iLeft * k;
+    const float *restrict dr = sd + (size_t)iRight * k;
+    float *restrict out = x + (size_t)i * k;
+
+#pragma omp simd
+    for (int j = 0; j < k; j++) {
+      out[j] = (di[j] + al * dl[j] + ga * dr[j]) / b;
+    }
+  }
+}
+
+int pcr_factor_solve(const pcr_factor_t *factor, float *rhs, float *scratch,
+                     float *x, int k, timer *start, timer *end) {
+  if (factor == NULL || rhs == NULL || scratch == NULL || x == NULL ||
+      k < 0) {
+    return -1;
+  }
+  const size_t n = factor->n;
+  if (n == 0 || k == 0) {
+    return 0; // Nothing to do
+  }
+
+  TIME_GET(*start);
+
+  const size_t levels = factor->levels;
+  const float *b_last = factor->b->data;
+  const int blocks = ((int)n + FACTOR_BLOCK - 1) / FACTOR_BLOCK;
+
+  if (levels == 0) {
+    for (int j = 0; j < k; j++) {
+      x[j] = rhs[j] / b_last[0];
+    }
+  }
+
+#pragma omp parallel
+  {
+    float *sd = rhs, *td = scratch;
+
+    for (size_t level = 0; level < levels; level++) {
+      const int last = level + 1 == levels;
+
+      // The last level writes x = d' / b' directly.
+#pragma omp for schedule(static)
+      for (int blk = 0; blk < blocks; blk++) {
+        const int i0 = blk * FACTOR_BLOCK;
+        const int i1 = i0 + FACTOR_BLOCK < (int)n ? i0 + FACTOR_BLOCK : (int)n;
+        const float *alpha = factor->alpha[level]->data;
+        const float *gamma = factor->gamma[level]->data;
+        if (last) {
+          solve_rhs(alpha, gamma, b_last, sd, x, (int)n, k, 1 << level, i0,
+                    i1);
+        } else {
+          update_rhs(alpha, gamma, sd, td, (int)n, k, 1 << level, i0, i1);
+        }
+      }
+
+      float *swap;
+      swap = sd, sd = td, td = swap;
+    }
+  }
+
+  TIME_GET(*end);
+
+  return 0;
+}
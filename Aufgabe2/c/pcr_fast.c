@@ -0,0 +1,92 @@
+#include "pcr_instrument.h"
+#include "pcr_kernel.h"
+#include "pcr_simd.h"
+#include "sle.h"
+#include "solver.h"
+#include "util.h"
+
+#include <omp.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+// As pcr_solve_system(), with the last level also taken by the
+// division-free kernel. A system of one equation is its own last level, at
+// stride 1.
+static void solve_system_rcp(pcr_update_range_rcp_fn kernel, float *sa,
+                             float *sb, float *sc, float *sd, float *ta,
+                             float *tb, float *tc, float *td,
+                             float *restrict x, int n) {
+  const size_t total_levels = pcr_total_levels((size_t)n);
+  const int last = total_levels > 0 ? (int)total_levels - 1 : 0;
+
+  PCR_INSTRUMENT_SOLVE_BEGIN(n, last + 1);
+
+#pragma omp parallel firstprivate(sa, sb, sc, sd, ta, tb, tc, td)
+  {
+    int lo, hi;
+    PCR_INSTRUMENT_THREAD_ENTER();
+    pcr_thread_range(n, omp_get_thread_num(), omp_get_num_threads(), &lo,
+                     &hi);
+
+    for (int level = 0; level < last; level++) {
+      PCR_INSTRUMENT_LEVEL_BEGIN(level);
+      kernel(sa, sb, sc, sd, ta, tb, tc, td, NULL, n, 1 << level, lo, hi);
+      // Same compulsory traffic as pcr(): a, b, c and d are read and
+      // written once.
+      PCR_INSTRUMENT_LEVEL_END(level, 8 * (size_t)(hi - lo) * sizeof(float));
+#pragma omp barrier
+
+      float *swap;
+      swap = sa, sa = ta, ta = swap;
+      swap = sb, sb = tb, tb = swap;
+      swap = sc, sc = tc, tc = swap;
+      swap = sd, sd = td, td = swap;
+    }
+
+    PCR_INSTRUMENT_LEVEL_BEGIN(last);
+    kernel(sa, sb, sc, sd, ta, tb, tc, td, x, n, 1 << last, lo, hi);
+    // The last level reads a, b, c and d and only writes x.
+    PCR_INSTRUMENT_LEVEL_END(last, 5 * (size_t)(hi - lo) * sizeof(float));
+    PCR_INSTRUMENT_THREAD_EXIT();
+  }
+
+  PCR_INSTRUMENT_SOLVE_END();
+}
+
+int pcr_fast(triSLE_t *sle, timer *start, timer *end) {
+  if (sle == NULL) {
+    return -1;
+  }
+  size_t n = sle->b->n;
+  if (n == 0) {
+    return 0; // Nothing to do
+  }
+
+  TIME_GET(*start);
+
+  float *tmp[4];
+  int failed = 0;
+  for (int k = 0; k < 4; k++) {
+    tmp[k] = (float *)malloc(n * sizeof(float));
+    failed |= tmp[k] == NULL;
+  }
+
+  if (failed) {
+    for (int k = 0; k < 4; k++) {
+      free(tmp[k]);
+    }
+    return -1; // Memory allocation failure
+  }
+
+  solve_system_rcp(pcr_update_range_rcp_select(), sle->a->data, sle->b->data,
+                   sle->c->data, sle->d->data, tmp[0], tmp[1], tmp[2], tmp[3],
+                   sle->x->data, (int)n);
+
+  TIME_GET(*end);
+
+  for (int k = 0; k < 4; k++) {
+    free(tmp[k]);
+  }
+
+  return 0;
+}
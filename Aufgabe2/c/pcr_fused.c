@@ -0,0 +1,155 @@
+#include "pcr_kernel.h"
+#include "pcr_simd.h"
+#include "sle.h"
+#include "solver.h"
+#include "util.h"
+#include "workspace.h"
+
+#include <omp.h>
+#include <stddef.h>
+#include <string.h>
+
+#define PCR_FUSED_DEFAULT_LEVELS 5
+
+// Run the first `levels` reductions tile by tile. Each tile is loaded together
+// with a halo of 2^levels - 1 equations on either side, which is exactly the
+// distance the reduced equations of the tile depend on after `levels` steps.
+// Equations in the halo become invalid step by step but are never written
+// back. The result of the last fused level is stored in ta..td. Every thread
+// works in its own tile buffer of the workspace.
+static void fused_levels(pcr_update_range_fn kernel, const pcr_workspace_t *ws,
+                         const float *sa, const float *sb, const float *sc,
+                         const float *sd, float *ta, float *tb, float *tc,
+                         float *td, int n, int levels) {
+  const int halo = (1 << levels) - 1;
+  const size_t span = ws->tile_span;
+  const int tiles = (n + PCR_FUSED_TILE - 1) / PCR_FUSED_TILE;
+  int threads = omp_get_max_threads();
+  if (threads > ws->tile_threads) {
+    threads = ws->tile_threads;
+  }
+
+#pragma omp parallel num_threads(threads)
+  {
+    float *buffer = ws->tiles + (size_t)omp_get_thread_num() * 8 * span;
+
+#pragma omp for schedule(static)
+    for (int tile = 0; tile < tiles; tile++) {
+      const int first = tile * PCR_FUSED_TILE;
+      const int last = first + PCR_FUSED_TILE < n ? first + PCR_FUSED_TILE : n;
+      const int g0 = first - halo > 0 ? first - halo : 0;
+      const int g1 = last + halo < n ? last + halo : n;
+      const int m = g1 - g0;
+
+      float *src[4], *dst[4];
+      for (int k = 0; k < 4; k++) {
+        src[k] = buffer + k * span;
+        dst[k] = buffer + (4 + k) * span;
+      }
+
+      memcpy(src[0], sa + g0, (size_t)m * sizeof(float));
+      memcpy(src[1], sb + g0, (size_t)m * sizeof(float));
+      memcpy(src[2], sc + g0, (size_t)m * sizeof(float));
+      memcpy(src[3], sd + g0, (size_t)m * sizeof(float));
+
+      // Neighbours outside the local window are treated as identity rows.
+      // That is exact at the ends of the system and only corrupts halo
+      // equations elsewhere.
+      for (int level = 0; level < levels; level++) {
+        kernel(src[0], src[1], src[2], src[3], dst[0], dst[1], dst[2], dst[3],
+               m, 1 << level, 0, m);
+        for (int k = 0; k < 4; k++) {
+          float *swap = src[k];
+          src[k] = dst[k];
+          dst[k] = swap;
+        }
+      }
+
+      const size_t count = (size_t)(last - first);
+      memcpy(ta + first, src[0] + (first - g0), count * sizeof(float));
+      memcpy(tb + first, src[1] + (first - g0), count * sizeof(float));
+      memcpy(tc + first, src[2] + (first - g0), count * sizeof(float));
+      memcpy(td + first, src[3] + (first - g0), count * sizeof(float));
+    }
+  }
+}
+
+int pcr_fused(triSLE_t *sle, pcr_workspace_t *ws, int levels, timer *start,
+              timer *end) {
+  if (sle == NULL || ws == NULL) {
+    return -1;
+  }
+  size_t n = sle->b->n;
+  if (n == 0) {
+    return 0; // Nothing to do
+  }
+  if (n > ws->max_n) {
+    return -1; // Workspace too small
+  }
+
+  TIME_GET(*start);
+
+  const size_t total_levels = pcr_total_levels(n);
+
+  float *sa = sle->a->data;
+  float *sb = sle->b->data;
+  float *sc = sle->c->data;
+  float *sd = sle->d->data;
+  float *ta = ws->tmp[0]->data;
+  float *tb = ws->tmp[1]->data;
+  float *tc = ws->tmp[2]->data;
+  float *td = ws->tmp[3]->data;
+  float *x = sle->x->data;
+
+  const pcr_update_range_fn kernel = pcr_update_range_select();
+
+  if (total_levels == 0) {
+    x[0] = sd[0] / sb[0];
+    TIME_GET(*end);
+    return 0;
+  }
+
+  // The last level is always a global sweep fused with x = d / b.
+  size_t fused = levels > 0 ? (size_t)levels : PCR_FUSED_DEFAULT_LEVELS;
+  if (fused > PCR_FUSED_MAX_LEVELS) {
+    fused = PCR_FUSED_MAX_LEVELS; // Deepest halo the tile buffers hold
+  }
+  if (fused > total_levels - 1) {
+    fused = total_levels - 1;
+  }
+
+  size_t level = 0;
+  if (fused > 0) {
+    fused_levels(kernel, ws, sa, sb, sc, sd, ta, tb, tc, td, (int)n,
+                 (int)fused);
+
+    float *swap;
+    swap = sa, sa = ta, ta = swap;
+    swap = sb, sb = tb, tb = swap;
+    swap = sc, sc = tc, tc = swap;
+    swap = sd, sd = td, td = swap;
+
+    level = fused;
+  }
+
+  for (; level + 1 < total_levels; level++) {
+    const int stride = 1 << level;
+    pcr_update_level(kernel, sa, sb, sc, sd, ta, tb, tc, td, (int)n, stride);
+
+    float *swap;
+    swap = sa, sa = ta, ta = swap;
+    swap = sb, sb = tb, tb = swap;
+    swap = sc, sc = tc, tc = swap;
+    swap = sd, sd = td, td = swap;
+  }
+
+  const int stride = 1 << (total_levels - 1);
+#pragma omp parallel for
+  for (int i = 0; i < (int)n; i++) {
+    pcr_solve_row(sa, sb, sc, sd, x, (int)n, stride, i);
+  }
+
+  TIME_GET(*end);
+
+  return 0;
+}
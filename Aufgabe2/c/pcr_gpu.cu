@@ -0,0 +1,230 @@
+#include "diagonal.h"
+#include "sle.h"
+#include "solver.h"
+#include "util.h"
+
+#include <cuda_runtime.h>
+
+#if defined(PCR_INSTRUMENT)
+#include <nvtx3/nvToolsExt.h>
+
+#include <stdio.h>
+#endif
+
+#include <stddef.h>
+
+#define EPSILON 1e-30f
+#define BLOCK_SIZE 256
+
+// NVTX ranges of the host-side phases, shown next to the kernels by Nsight
+// Systems. Compiled out unless PCR_INSTRUMENT is defined.
+#if defined(PCR_INSTRUMENT)
+#define GPU_RANGE_PUSH(name) nvtxRangePushA(name)
+#define GPU_RANGE_POP() nvtxRangePop()
+#else
+#define GPU_RANGE_PUSH(name) ((void)0)
+#define GPU_RANGE_POP() ((void)0)
+#endif
+
+#define CUDA_CHECK(call)                                                       \
+  do {                                                                         \
+    if ((call) != cudaSuccess) {                                               \
+      goto error;                                                              \
+    }                                                                          \
+  } while (0)
+
+// Device buffers are kept between calls so that repeated solves of the same
+// (or a smaller) size do not pay for cudaMalloc/cudaFree every time. Two sets
+// of a/b/c/d are needed to ping-pong between the levels.
+static float *dev_abcd[2][4] = {{NULL, NULL, NULL, NULL},
+                                {NULL, NULL, NULL, NULL}};
+static float *dev_x = NULL;
+static size_t dev_capacity = 0;
+
+// With Fast, the division is __fdividef(), i.e. an approximate reciprocal
+// and a multiplication.
+template <bool Fast> __device__ __forceinline__ float divide(float x, float y) {
+  return Fast ? __fdividef(x, y) : x / y;
+}
+
+template <bool Fast>
+__device__ __forceinline__ float compute_decoupling_coeffs(float decoupling_value,
+                                                           float into_value) {
+  return divide<Fast>(-into_value,
+                      decoupling_value == 0 ? EPSILON : decoupling_value);
+}
+
+template <bool Fast>
+__global__ void update_step_kernel(const float *__restrict__ sa,
+                                   const float *__restrict__ sb,
+                                   const float *__restrict__ sc,
+                                   const float *__restrict__ sd,
+                                   float *__restrict__ tmp_a,
+                                   float *__restrict__ tmp_b,
+                                   float *__restrict__ tmp_c,
+                                   float *__restrict__ tmp_d, int n,
+                                   int stride) {
+  const int i = blockIdx.x * blockDim.x + threadIdx.x;
+  if (i >= n) {
+    return;
+  }
+
+  const int iRight = i + stride;
+  const int iLeft = i - stride;
+
+  const float alpha =
+      compute_decoupling_coeffs<Fast>(iLeft < 0 ? 1.f : sb[iLeft], sa[i]);
+  const float gamma =
+      compute_decoupling_coeffs<Fast>(iRight < n ? sb[iRight] : 1.f, sc[i]);
+
+  const float sa_iLeft = iLeft < 0 ? 0.0f : sa[iLeft];
+  const float sc_iLeft = iLeft < 0 ? 0.0f : sc[iLeft];
+  const float sd_iLeft = iLeft < 0 ? 0.0f : sd[iLeft];
+
+  const float sa_iRight = iRight >= n ? 0.0f : sa[iRight];
+  const float sc_iRight = iRight >= n ? 0.0f : sc[iRight];
+  const float sd_iRight = iRight >= n ? 0.0f : sd[iRight];
+
+  tmp_a[i] = alpha * sa_iLeft;
+  tmp_c[i] = gamma * sc_iRight;
+  tmp_b[i] = sb[i] + alpha * sc_iLeft + gamma * sa_iRight;
+  tmp_d[i] = sd[i] + alpha * sd_iLeft + gamma * sd_iRight;
+}
+
+template <bool Fast>
+__global__ void solve_kernel(const float *__restrict__ sb,
+                             const float *__restrict__ sd,
+                             float *__restrict__ x, int n) {
+  const int i = blockIdx.x * blockDim.x + threadIdx.x;
+  if (i < n) {
+    x[i] = divide<Fast>(sd[i], sb[i]);
+  }
+}
+
+// Same as pcr_total_levels() in pcr_kernel.h, which is C only. Counted in
+// integers, as ceil(log2((float)n)) rounds to one level too few for n just
+// above a power of two.
+static size_t total_levels_of(size_t n) {
+  size_t levels = 0;
+  while (((size_t)1 << levels) < n) {
+    levels++;
+  }
+  return levels;
+}
+
+static int reserve_device_buffers(size_t n) {
+  if (n <= dev_capacity) {
+    return 0;
+  }
+
+  pcr_gpu_release();
+
+  for (int set = 0; set < 2; set++) {
+    for (int k = 0; k < 4; k++) {
+      CUDA_CHECK(cudaMalloc(&dev_abcd[set][k], n * sizeof(float)));
+    }
+  }
+  CUDA_CHECK(cudaMalloc(&dev_x, n * sizeof(float)));
+
+  dev_capacity = n;
+  return 0; // Success
+
+error:
+  pcr_gpu_release();
+  return -1; // Device memory allocation failed
+}
+
+int pcr_gpu_release(void) {
+  for (int set = 0; set < 2; set++) {
+    for (int k = 0; k < 4; k++) {
+      if (dev_abcd[set][k] != NULL) {
+        cudaFree(dev_abcd[set][k]);
+        dev_abcd[set][k] = NULL;
+      }
+    }
+  }
+  if (dev_x != NULL) {
+    cudaFree(dev_x);
+    dev_x = NULL;
+  }
+  dev_capacity = 0;
+
+  return 0; // Success
+}
+
+template <bool Fast>
+static int solve_on_device(triSLE_t *sle, timer *start, timer *end) {
+  if (sle == NULL) {
+    return -1;
+  }
+  size_t n = sle->b->n;
+  if (n == 0) {
+    return 0; // Nothing to do
+  }
+
+  TIME_GET(*start);
+
+  if (reserve_device_buffers(n) != 0) {
+    return -1;
+  }
+
+  {
+    const size_t bytes = n * sizeof(float);
+    const size_t total_levels = total_levels_of(n);
+    const int blocks = (int)((n + BLOCK_SIZE - 1) / BLOCK_SIZE);
+
+    float *const *src = dev_abcd[0];
+    float *const *dst = dev_abcd[1];
+
+    GPU_RANGE_PUSH("pcr_gpu upload");
+    CUDA_CHECK(cudaMemcpy(src[0], sle->a->data, bytes, cudaMemcpyHostToDevice));
+    CUDA_CHECK(cudaMemcpy(src[1], sle->b->data, bytes, cudaMemcpyHostToDevice));
+    CUDA_CHECK(cudaMemcpy(src[2], sle->c->data, bytes, cudaMemcpyHostToDevice));
+    CUDA_CHECK(cudaMemcpy(src[3], sle->d->data, bytes, cudaMemcpyHostToDevice));
+    GPU_RANGE_POP();
+
+    // The two buffer sets simply trade roles after every level, so no data
+    // ever has to be copied back regardless of the parity of total_levels.
+    GPU_RANGE_PUSH("pcr_gpu reduce");
+    for (size_t level = 0; level < total_levels; level++) {
+#if defined(PCR_INSTRUMENT)
+      char range[32];
+      snprintf(range, sizeof(range), "pcr_level_%zu", level);
+      nvtxRangePushA(range);
+#endif
+      update_step_kernel<Fast><<<blocks, BLOCK_SIZE>>>(
+          src[0], src[1], src[2], src[3], dst[0], dst[1], dst[2], dst[3],
+          (int)n, 1 << level);
+      GPU_RANGE_POP();
+      CUDA_CHECK(cudaGetLastError());
+
+      float *const *swap = src;
+      src = dst;
+      dst = swap;
+    }
+
+    solve_kernel<Fast><<<blocks, BLOCK_SIZE>>>(src[1], src[3], dev_x,
+                                               (int)n);
+    GPU_RANGE_POP();
+    CUDA_CHECK(cudaGetLastError());
+
+    GPU_RANGE_PUSH("pcr_gpu download");
+    CUDA_CHECK(cudaMemcpy(sle->x->data, dev_x, bytes, cudaMemcpyDeviceToHost));
+    GPU_RANGE_POP();
+  }
+
+  TIME_GET(*end);
+
+  return 0; // Success
+
+error:
+  return -1; // CUDA runtime error
+}
+
+int pcr_gpu(triSLE_t *sle, timer *start, timer *end) {
+  return solve_on_device<false>(sle, start, end);
+}
+
+int pcr_gpu_fast(triSLE_t *sle, timer *start, timer *end) {
+  return solve_on_device<true>(sle, start, end);
+}
@@ -0,0 +1,232 @@
+#include "pcr_instrument.h"
+
+#if defined(PCR_INSTRUMENT)
+
+#include "solver.h"
+
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(LIKWID_PERFMON)
+#include <likwid-marker.h>
+#endif
+
+// Timestamps of one thread during the current call, padded to cache lines so
+// that the threads do not share lines while they record.
+typedef struct {
+  double enter, exit;
+  double start[PCR_INSTRUMENT_MAX_LEVELS];
+  double end[PCR_INSTRUMENT_MAX_LEVELS];
+  size_t bytes[PCR_INSTRUMENT_MAX_LEVELS];
+} __attribute__((aligned(64))) thread_record_t;
+
+// Sums over all calls of a single configuration.
+typedef struct {
+  int n, levels, threads;
+  long calls;
+  double total, fork, join;
+  double wall[PCR_INSTRUMENT_MAX_LEVELS];
+  double busy_max[PCR_INSTRUMENT_MAX_LEVELS];
+  double busy_sum[PCR_INSTRUMENT_MAX_LEVELS];
+  double bytes[PCR_INSTRUMENT_MAX_LEVELS];
+} statistics_t;
+
+static thread_record_t records[PCR_INSTRUMENT_MAX_THREADS];
+static statistics_t stats;
+
+// The call in progress
+static int call_n, call_levels, call_threads;
+static double call_start;
+
+#if defined(LIKWID_PERFMON)
+static char region_names[PCR_INSTRUMENT_MAX_LEVELS][16];
+
+static void likwid_begin(int level, int tid) {
+  (void)tid;
+  LIKWID_MARKER_START(region_names[level]);
+}
+
+static void likwid_end(int level, int tid) {
+  (void)tid;
+  LIKWID_MARKER_STOP(region_names[level]);
+}
+
+static void likwid_close(void) { LIKWID_MARKER_CLOSE; }
+
+static pcr_instrument_hook_fn hook_begin = likwid_begin;
+static pcr_instrument_hook_fn hook_end = likwid_end;
+#else
+static pcr_instrument_hook_fn hook_begin = NULL;
+static pcr_instrument_hook_fn hook_end = NULL;
+#endif
+
+void pcr_instrument_set_hooks(pcr_instrument_hook_fn begin,
+                              pcr_instrument_hook_fn end) {
+  hook_begin = begin;
+  hook_end = end;
+}
+
+void pcr_instrument_reset(void) { memset(&stats, 0, sizeof(stats)); }
+
+static double pcr_instrument_now(void) { return omp_get_wtime(); }
+
+void pcr_instrument_solve_begin(int n, int levels) {
+#if defined(LIKWID_PERFMON)
+  static int likwid_ready = 0;
+  if (!likwid_ready) {
+    for (int level = 0; level < PCR_INSTRUMENT_MAX_LEVELS; level++) {
+      snprintf(region_names[level], sizeof(region_names[level]),
+               "pcr_level_%d", level);
+    }
+    LIKWID_MARKER_INIT;
+    atexit(likwid_close);
+    likwid_ready = 1;
+  }
+#endif
+
+  call_n = n;
+  call_levels =
+      levels < PCR_INSTRUMENT_MAX_LEVELS ? levels : PCR_INSTRUMENT_MAX_LEVELS;
+  call_threads = 0;
+  call_start = pcr_instrument_now();
+}
+
+void pcr_instrument_thread_enter(void) {
+  const int tid = omp_get_thread_num();
+  if (tid == 0) {
+    call_threads = omp_get_num_threads();
+  }
+  if (tid < PCR_INSTRUMENT_MAX_THREADS) {
+    records[tid].enter = pcr_instrument_now();
+  }
+}
+
+void pcr_instrument_level_begin(int level) {
+  const int tid = omp_get_thread_num();
+  if (tid >= PCR_INSTRUMENT_MAX_THREADS || level >= call_levels) {
+    return;
+  }
+
+  if (hook_begin != NULL) {
+    hook_begin(level, tid);
+  }
+  records[tid].start[level] = pcr_instrument_now();
+}
+
+void pcr_instrument_level_end(int level, size_t bytes) {
+  const int tid = omp_get_thread_num();
+  if (tid >= PCR_INSTRUMENT_MAX_THREADS || level >= call_levels) {
+    return;
+  }
+
+  records[tid].end[level] = pcr_instrument_now();
+  records[tid].bytes[level] = bytes;
+  if (hook_end != NULL) {
+    hook_end(level, tid);
+  }
+}
+
+void pcr_instrument_thread_exit(void) {
+  const int tid = omp_get_thread_num();
+  if (tid < PCR_INSTRUMENT_MAX_THREADS) {
+    records[tid].exit = pcr_instrument_now();
+  }
+}
+
+void pcr_instrument_solve_end(void) {
+  const double call_end = pcr_instrument_now();
+  const int threads = call_threads < PCR_INSTRUMENT_MAX_THREADS
+                          ? call_threads
+                          : PCR_INSTRUMENT_MAX_THREADS;
+
+  if (stats.n != call_n || stats.levels != call_levels ||
+      stats.threads != call_threads) {
+    pcr_instrument_reset();
+    stats.n = call_n;
+    stats.levels = call_levels;
+    stats.threads = call_threads;
+  }
+
+  // The region is forked once the last thread entered it and joined once the
+  // master resumes after the last thread left it.
+  double last_enter = call_start, last_exit = call_start;
+  for (int t = 0; t < threads; t++) {
+    last_enter = records[t].enter > last_enter ? records[t].enter : last_enter;
+    last_exit = records[t].exit > last_exit ? records[t].exit : last_exit;
+  }
+
+  stats.calls++;
+  stats.total += call_end - call_start;
+  stats.fork += last_enter - call_start;
+  stats.join += call_end - last_exit;
+
+  for (int level = 0; level < call_levels; level++) {
+    double first_start = records[0].start[level];
+    double last_end = records[0].end[level];
+    double busy_max = 0.0, busy_sum = 0.0, bytes = 0.0;
+
+    for (int t = 0; t < threads; t++) {
+      const double busy = records[t].end[level] - records[t].start[level];
+      first_start = records[t].start[level] < first_start
+                        ? records[t].start[level]
+                        : first_start;
+      last_end = records[t].end[level] > last_end ? records[t].end[level]
+                                                  : last_end;
+      busy_max = busy > busy_max ? busy : busy_max;
+      busy_sum += busy;
+      bytes += (double)records[t].bytes[level];
+    }
+
+    stats.wall[level] += last_end - first_start;
+    stats.busy_max[level] += busy_max;
+    stats.busy_sum[level] += busy_sum;
+    stats.bytes[level] += bytes;
+  }
+}
+
+int pcr_instrument_dump(const char *path) {
+  FILE *out = path != NULL ? fopen(path, "w") : stderr;
+  if (out == NULL) {
+    return -1; // Failed to open the file
+  }
+
+  const double calls = stats.calls > 0 ? (double)stats.calls : 1.0;
+  const int threads = stats.threads < PCR_INSTRUMENT_MAX_THREADS
+                          ? stats.threads
+                          : PCR_INSTRUMENT_MAX_THREADS;
+
+  fprintf(out,
+          "{\"kernel\": \"%s\", \"n\": %d, \"threads\": %d, \"calls\": %ld, "
+          "\"total_s\": %.9f, \"fork_s\": %.9f, \"join_s\": %.9f,\n"
+          " \"levels\": [",
+          pcr_kernel_name(), stats.n, stats.threads, stats.calls,
+          stats.total / calls, stats.fork / calls, stats.join / calls);
+
+  for (int level = 0; level < stats.levels; level++) {
+    const double wall = stats.wall[level] / calls;
+    const double busy_max = stats.busy_max[level] / calls;
+    const double busy_mean =
+        threads > 0 ? stats.busy_sum[level] / calls / threads : 0.0;
+    const double bytes = stats.bytes[level] / calls;
+
+    // imbalance is the slowest thread relative to the average one: the
+    // others wait for max - mean at the following barrier.
+    fprintf(out,
+            "%s\n  {\"level\": %d, \"stride\": %lu, \"time_s\": %.9f, "
+            "\"busy_max_s\": %.9f, \"busy_mean_s\": %.9f, "
+            "\"imbalance\": %.4f, \"bytes\": %.0f, \"gbs\": %.3f}",
+            level > 0 ? "," : "", level, 1UL << level, wall, busy_max,
+            busy_mean, busy_mean > 0.0 ? busy_max / busy_mean : 1.0, bytes,
+            wall > 0.0 ? bytes / wall * 1e-9 : 0.0);
+  }
+  fprintf(out, "\n ]}\n");
+
+  if (path != NULL) {
+    return fclose(out) == 0 ? 0 : -1;
+  }
+  return 0; // Success
+}
+
+#endif // PCR_INSTRUMENT
@@ -0,0 +1,112 @@
+/**
+ * @file pcr_instrument.h
+ * @brief Optional per-level instrumentation of the PCR solvers.
+ *
+ * Compiled out unless PCR_INSTRUMENT is defined (make INSTRUMENT=1). The
+ * solvers then record, for every level of the single parallel region of
+ * pcr_solve_system(), the time every thread spends in the reduction kernel
+ * and the bytes it moves, and the fork and join overhead of the region.
+ * pcr_instrument_dump() writes the per-call averages as JSON.
+ *
+ * Hardware counters are read by hooks that every thread calls around every
+ * level, e.g. PAPI_start()/PAPI_stop(). With LIKWID_PERFMON defined
+ * (make INSTRUMENT=likwid) the default hooks open a likwid marker region
+ * "pcr_level_<level>" per level.
+ *
+ * Without PCR_INSTRUMENT all PCR_INSTRUMENT_* macros expand to nothing, so
+ * the call sites need no preprocessor conditionals.
+ */
+
+#ifndef PCR_INSTRUMENT_H
+#define PCR_INSTRUMENT_H
+
+#include <stddef.h>
+
+/** Levels recorded per call, enough for any n representable in size_t. */
+#define PCR_INSTRUMENT_MAX_LEVELS 64
+
+/** Threads recorded per level. Further threads are not instrumented. */
+#define PCR_INSTRUMENT_MAX_THREADS 256
+
+/**
+ * @typedef pcr_instrument_hook_fn
+ * @brief Hook a thread calls right before or after its part of a level.
+ *
+ * @param[in] level  Level of the reduction, from 0.
+ * @param[in] tid    OpenMP thread number.
+ */
+typedef void (*pcr_instrument_hook_fn)(int level, int tid);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(PCR_INSTRUMENT)
+
+/**
+ * @brief Replace the hooks called around every level.
+ *
+ * @param[in] begin  Called before the kernel of a level, or NULL.
+ * @param[in] end    Called after the kernel of a level, or NULL.
+ *
+ * @note Hooks run concurrently on all threads of the region, outside of the
+ *       measured kernel time.
+ */
+void pcr_instrument_set_hooks(pcr_instrument_hook_fn begin,
+                              pcr_instrument_hook_fn end);
+
+/**
+ * @brief Discard all recorded calls.
+ */
+void pcr_instrument_reset(void);
+
+/**
+ * @brief Write the recorded statistics as a JSON object.
+ *
+ * Times are averages over all calls since the last reset. Statistics are
+ * reset when a system of a different size or with a different number of
+ * threads is solved, so they always describe a single configuration.
+ *
+ * @param[in] path  File to write, or NULL for stderr.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int pcr_instrument_dump(const char *path);
+
+/** @cond INTERNAL */
+// Called by pcr_solve_system(); see pcr_kernel.h.
+void pcr_instrument_solve_begin(int n, int levels);
+void pcr_instrument_thread_enter(void);
+void pcr_instrument_level_begin(int level);
+void pcr_instrument_level_end(int level, size_t bytes);
+void pcr_instrument_thread_exit(void);
+void pcr_instrument_solve_end(void);
+/** @endcond */
+
+#define PCR_INSTRUMENT_SOLVE_BEGIN(n, levels)                                  \
+  pcr_instrument_solve_begin(n, levels)
+#define PCR_INSTRUMENT_THREAD_ENTER() pcr_instrument_thread_enter()
+#define PCR_INSTRUMENT_LEVEL_BEGIN(level) pcr_instrument_level_begin(level)
+#define PCR_INSTRUMENT_LEVEL_END(level, bytes)                                 \
+  pcr_instrument_level_end(level, bytes)
+#define PCR_INSTRUMENT_THREAD_EXIT() pcr_instrument_thread_exit()
+#define PCR_INSTRUMENT_SOLVE_END() pcr_instrument_solve_end()
+#define PCR_INSTRUMENT_DUMP(path) pcr_instrument_dump(path)
+
+#else
+
+#define PCR_INSTRUMENT_SOLVE_BEGIN(n, levels) ((void)0)
+#define PCR_INSTRUMENT_THREAD_ENTER() ((void)0)
+#define PCR_INSTRUMENT_LEVEL_BEGIN(level) ((void)0)
+#define PCR_INSTRUMENT_LEVEL_END(level, bytes) ((void)0)
+#define PCR_INSTRUMENT_THREAD_EXIT() ((void)0)
+#define PCR_INSTRUMENT_SOLVE_END() ((void)0)
+#define PCR_INSTRUMENT_DUMP(path) ((void)0)
+
+#endif // PCR_INSTRUMENT
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PCR_INSTRUMENT_H
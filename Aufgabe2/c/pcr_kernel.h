@@ -0,0 +1,189 @@
+/**
+ * @file pcr_kernel.h
+ * @brief Internal building blocks shared by the CPU PCR solvers.
+ *
+ * This header is not part of the public solver interface. It contains the
+ * per-equation reduction step so that all CPU variants (single system,
+ * batched, ...) perform exactly the same arithmetic. The reduction step is
+ * instantiated from pcr_kernel_impl.h for float and, with the suffix _d, for
+ * double.
+ */
+
+#ifndef PCR_KERNEL_H
+#define PCR_KERNEL_H
+
+#include "pcr_instrument.h"
+#include "pcr_simd.h"
+
+#include <omp.h>
+#include <stddef.h>
+
+#define EPSILON 1e-30
+
+#define REAL float
+#define PCR_NAME(name) name
+#include "pcr_kernel_impl.h"
+
+#define REAL double
+#define PCR_NAME(name) name##_d
+#include "pcr_kernel_impl.h"
+
+/**
+ * @brief Thomas algorithm over interleaved subsystems.
+ *
+ * Solves the independent subsystems j in [j0, j1) formed by the rows j,
+ * j + stride, j + 2 * stride, ... of a system with n equations. Coupling to
+ * rows outside [0, n) is ignored. The subsystems are swept together row by
+ * row, so consecutive j access consecutive memory. The c and d diagonals are
+ * overwritten with the forward-sweep coefficients.
+ */
+static inline void thomas_interleaved(const float *restrict a,
+                                      const float *restrict b,
+                                      float *restrict c, float *restrict d,
+                                      float *restrict x, int n, int stride,
+                                      int j0, int j1) {
+  if (j1 > n) {
+    j1 = n;
+  }
+
+  for (int j = j0; j < j1; j++) {
+    const float denom = b[j];
+    c[j] = c[j] / denom;
+    d[j] = d[j] / denom;
+  }
+
+  for (int row = stride; row < n; row += stride) {
+    const int end = row + j1 > n ? n - row : j1;
+    for (int j = j0; j < end; j++) {
+      const int i = row + j;
+      const float denom = b[i] - a[i] * c[i - stride];
+      c[i] = c[i] / denom;
+      d[i] = (d[i] - a[i] * d[i - stride]) / denom;
+    }
+  }
+
+  const int last_row = ((n - 1) / stride) * stride;
+  for (int row = last_row; row >= 0; row -= stride) {
+    const int end = row + j1 > n ? n - row : j1;
+    for (int j = j0; j < end; j++) {
+      const int i = row + j;
+      x[i] = i + stride < n ? d[i] - c[i] * x[i + stride] : d[i];
+    }
+  }
+}
+
+/**
+ * @brief Static partition of n equations over the threads of a team.
+ *
+ * Thread tid of nthreads gets the contiguous range [*lo, *hi). Range
+ * boundaries are multiples of 16 equations (one cache line of floats), so
+ * neighbouring threads never write to the same line.
+ */
+static inline void pcr_thread_range(int n, int tid, int nthreads, int *lo,
+                                    int *hi) {
+  const int lines = (n + 15) / 16;
+  const int per_thread = (lines + nthreads - 1) / nthreads;
+
+  *lo = tid * per_thread * 16;
+  *hi = *lo + per_thread * 16;
+  if (*lo > n) {
+    *lo = n;
+  }
+  if (*hi > n) {
+    *hi = n;
+  }
+}
+
+/**
+ * @brief Reduce all n equations of one level in a new parallel region.
+ *
+ * Every thread applies the kernel to its pcr_thread_range().
+ */
+static inline void pcr_update_level(pcr_update_range_fn kernel,
+                                    const float *sa, const float *sb,
+                                    const float *sc, const float *sd,
+                                    float *tmp_a, float *tmp_b, float *tmp_c,
+                                    float *tmp_d, int n, int stride) {
+#pragma omp parallel
+  {
+    int lo, hi;
+    pcr_thread_range(n, omp_get_thread_num(), omp_get_num_threads(), &lo,
+                     &hi);
+    kernel(sa, sb, sc, sd, tmp_a, tmp_b, tmp_c, tmp_d, n, stride, lo, hi);
+  }
+}
+
+/**
+ * @brief Number of PCR levels needed to decouple n equations.
+ */
+static inline size_t pcr_total_levels(size_t n) {
+  size_t levels = 0;
+  while (((size_t)1 << levels) < n) {
+    levels++;
+  }
+  return levels;
+}
+
+/**
+ * @brief Reduce and solve a system of n >= 1 equations in one parallel
+ * region.
+ *
+ * Instead of one fork/join per level, the threads stay in a single region:
+ * every thread reduces its pcr_thread_range() and swaps its own copy of the
+ * buffer pointers after a barrier. The last level, where every equation
+ * decouples, is fused with x = d / b. Both sa..sd and ta..td are used as
+ * work space.
+ *
+ * Built with PCR_INSTRUMENT, every level is timed per thread (see
+ * pcr_instrument.h).
+ */
+static inline void pcr_solve_system(pcr_update_range_fn kernel, float *sa,
+                                    float *sb, float *sc, float *sd,
+                                    float *ta, float *tb, float *tc,
+                                    float *td, float *restrict x, int n) {
+  const size_t total_levels = pcr_total_levels((size_t)n);
+
+  if (total_levels == 0) {
+    x[0] = sd[0] / sb[0];
+    return;
+  }
+
+  PCR_INSTRUMENT_SOLVE_BEGIN(n, (int)total_levels);
+
+#pragma omp parallel firstprivate(sa, sb, sc, sd, ta, tb, tc, td)
+  {
+    int lo, hi;
+    PCR_INSTRUMENT_THREAD_ENTER();
+    pcr_thread_range(n, omp_get_thread_num(), omp_get_num_threads(), &lo,
+                     &hi);
+
+    for (size_t level = 0; level + 1 < total_levels; level++) {
+      PCR_INSTRUMENT_LEVEL_BEGIN((int)level);
+      kernel(sa, sb, sc, sd, ta, tb, tc, td, n, 1 << level, lo, hi);
+      // Compulsory traffic: a, b, c and d are read and written once.
+      PCR_INSTRUMENT_LEVEL_END((int)level,
+                               8 * (size_t)(hi - lo) * sizeof(float));
+#pragma omp barrier
+
+      float *swap;
+      swap = sa, sa = ta, ta = swap;
+      swap = sb, sb = tb, tb = swap;
+      swap = sc, sc = tc, tc = swap;
+      swap = sd, sd = td, td = swap;
+    }
+
+    const int stride = 1 << (total_levels - 1);
+    PCR_INSTRUMENT_LEVEL_BEGIN((int)total_levels - 1);
+    for (int i = lo; i < hi; i++) {
+      pcr_solve_row(sa, sb, sc, sd, x, n, stride, i);
+    }
+    // The last level reads a, b, c and d and only writes x.
+    PCR_INSTRUMENT_LEVEL_END((int)total_levels - 1,
+                             5 * (size_t)(hi - lo) * sizeof(float));
+    PCR_INSTRUMENT_THREAD_EXIT();
+  }
+
+  PCR_INSTRUMENT_SOLVE_END();
+}
+
+#endif // PCR_KERNEL_H
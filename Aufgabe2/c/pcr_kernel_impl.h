@@ -0,0 +1,84 @@
+/**
+ * @file pcr_kernel_impl.h
+ * @brief Precision-generic PCR reduction step.
+ *
+ * This file is a template that pcr_kernel.h includes once per precision.
+ * Before inclusion the following macros must be defined:
+ * - REAL:           element type (float or double)
+ * - PCR_NAME(name): function name for the precision
+ *
+ * The macros are undefined again at the end of the file.
+ */
+
+static inline REAL PCR_NAME(compute_decoupling_coeffs)(REAL decoupling_value,
+                                                       REAL into_value) {
+  return -into_value / (decoupling_value == 0 ? EPSILON : decoupling_value);
+}
+
+/**
+ * @brief Reduce equation i of a system with n equations at the given stride.
+ *
+ * Reads the coefficients of equation i and its neighbours i - stride and
+ * i + stride from sa..sd and writes the reduced equation to tmp_a..tmp_d.
+ * Neighbours outside [0, n) are treated as the identity equation.
+ */
+static inline void
+PCR_NAME(pcr_update_row)(const REAL *restrict sa, const REAL *restrict sb,
+                         const REAL *restrict sc, const REAL *restrict sd,
+                         REAL *restrict tmp_a, REAL *restrict tmp_b,
+                         REAL *restrict tmp_c, REAL *restrict tmp_d, int n,
+                         int stride, int i) {
+  int iRight = i + stride;
+  int iLeft = i - stride;
+
+  const REAL alpha = PCR_NAME(compute_decoupling_coeffs)(
+      iLeft < 0 ? (REAL)1 : sb[iLeft], sa[i]);
+  const REAL gamma = PCR_NAME(compute_decoupling_coeffs)(
+      iRight < n ? sb[iRight] : (REAL)1, sc[i]);
+
+  const REAL sa_iLeft = iLeft < 0 ? (REAL)0 : sa[iLeft];
+  const REAL sc_iLeft = iLeft < 0 ? (REAL)0 : sc[iLeft];
+  const REAL sd_iLeft = iLeft < 0 ? (REAL)0 : sd[iLeft];
+
+  const REAL sa_iRight = iRight >= n ? (REAL)0 : sa[iRight];
+  const REAL sc_iRight = iRight >= n ? (REAL)0 : sc[iRight];
+  const REAL sd_iRight = iRight >= n ? (REAL)0 : sd[iRight];
+
+  tmp_a[i] = alpha * sa_iLeft;
+  tmp_c[i] = gamma * sc_iRight;
+  tmp_b[i] = sb[i] + alpha * sc_iLeft + gamma * sa_iRight;
+  tmp_d[i] = sd[i] + alpha * sd_iLeft + gamma * sd_iRight;
+}
+
+/**
+ * @brief Reduce equation i at the given stride and solve it directly.
+ *
+ * Performs the same reduction as pcr_update_row() for the last level, where
+ * every equation decouples, and writes x[i] = d' / b' instead of storing the
+ * reduced coefficients.
+ */
+static inline void
+PCR_NAME(pcr_solve_row)(const REAL *restrict sa, const REAL *restrict sb,
+                        const REAL *restrict sc, const REAL *restrict sd,
+                        REAL *restrict x, int n, int stride, int i) {
+  int iRight = i + stride;
+  int iLeft = i - stride;
+
+  const REAL alpha = PCR_NAME(compute_decoupling_coeffs)(
+      iLeft < 0 ? (REAL)1 : sb[iLeft], sa[i]);
+  const REAL gamma = PCR_NAME(compute_decoupling_coeffs)(
+      iRight < n ? sb[iRight] : (REAL)1, sc[i]);
+
+  const REAL sc_iLeft = iLeft < 0 ? (REAL)0 : sc[iLeft];
+  const REAL sd_iLeft = iLeft < 0 ? (REAL)0 : sd[iLeft];
+
+  const REAL sa_iRight = iRight >= n ? (REAL)0 : sa[iRight];
+  const REAL sd_iRight = iRight >= n ? (REAL)0 : sd[iRight];
+
+  const REAL b = sb[i] + alpha * sc_iLeft + gamma * sa_iRight;
+  const REAL d = sd[i] + alpha * sd_iLeft + gamma * sd_iRight;
+  x[i] = d / b;
+}
+
+#undef REAL
+#undef PCR_NAME
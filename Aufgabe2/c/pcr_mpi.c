@@ -0,0 +1,162 @@
+#include "pcr_mpi.h"
+#include "partition.h"
+#include "sle.h"
+#include "solver.h"
+#include "util.h"
+
+#include <mpi.h>
+#include <omp.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+// First row of chunk j when m rows are split into parts chunks.
+static inline size_t chunk_begin(size_t m, int parts, int j) {
+  return m * (size_t)j / (size_t)parts;
+}
+
+int pcr_mpi(triSLE_t *local, MPI_Comm comm, timer *start, timer *end) {
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  const size_t m = local != NULL ? local->b->n : 0;
+  int parts = omp_get_max_threads();
+  if ((size_t)parts > m) {
+    parts = (int)m;
+  }
+
+  float *coeffs = (float *)malloc(3 * m * sizeof(float));
+  partition_chunk_t *chunks =
+      (partition_chunk_t *)malloc((size_t)(parts > 0 ? parts : 1) *
+                                  sizeof(partition_chunk_t));
+  float *interface = (float *)malloc((size_t)(parts + 1) * sizeof(float));
+
+  // Only allocated on rank 0
+  int *chunk_counts = NULL, *chunk_displs = NULL;
+  int *value_counts = NULL, *value_displs = NULL;
+  partition_chunk_t *all_chunks = NULL;
+  float *values = NULL;
+  triSLE_t *reduced = NULL;
+
+  int failed = m == 0 || coeffs == NULL || chunks == NULL || interface == NULL;
+
+  if (rank == 0) {
+    chunk_counts = (int *)malloc((size_t)size * sizeof(int));
+    chunk_displs = (int *)malloc((size_t)size * sizeof(int));
+    value_counts = (int *)malloc((size_t)size * sizeof(int));
+    value_displs = (int *)malloc((size_t)size * sizeof(int));
+    failed |= chunk_counts == NULL || chunk_displs == NULL ||
+              value_counts == NULL || value_displs == NULL;
+  }
+
+  MPI_Allreduce(MPI_IN_PLACE, &failed, 1, MPI_INT, MPI_LOR, comm);
+
+  // Rank 0 learns how many chunks every rank contributes and sets up the
+  // reduced system.
+  int total = 0;
+  if (!failed) {
+    MPI_Gather(&parts, 1, MPI_INT, value_counts, 1, MPI_INT, 0, comm);
+
+    if (rank == 0) {
+      for (int r = 0; r < size; r++) {
+        chunk_counts[r] = value_counts[r] * PARTITION_CHUNK_FLOATS;
+        chunk_displs[r] = total * PARTITION_CHUNK_FLOATS;
+        // Interface values of the chunks plus the one before them
+        value_displs[r] = total + r;
+        value_counts[r] += 1;
+        total += value_counts[r] - 1;
+      }
+
+      all_chunks =
+          (partition_chunk_t *)malloc((size_t)total * sizeof(partition_chunk_t));
+      values = (float *)malloc((size_t)(total + size) * sizeof(float));
+      failed = all_chunks == NULL || values == NULL ||
+               triSLE_create(&reduced, total) != 0;
+    }
+
+    MPI_Bcast(&failed, 1, MPI_INT, 0, comm);
+  }
+
+  if (!failed) {
+    const float *a = local->a->data;
+    const float *b = local->b->data;
+    const float *c = local->c->data;
+    const float *d = local->d->data;
+    float *x = local->x->data;
+    float *y = coeffs;
+    float *u = coeffs + m;
+    float *v = coeffs + 2 * m;
+
+    MPI_Barrier(comm);
+    TIME_GET(*start);
+
+    // x doubles as the scratch array of the elimination and is only written
+    // with the solution afterwards.
+#pragma omp parallel for schedule(static)
+    for (int j = 0; j < parts; j++) {
+      const size_t lo = chunk_begin(m, parts, j);
+      const size_t hi = chunk_begin(m, parts, j + 1);
+      partition_eliminate(a + lo, b + lo, c + lo, d + lo, hi - lo,
+                          rank == 0 && j == 0,
+                          rank == size - 1 && j == parts - 1, y + lo, u + lo,
+                          v + lo, x + lo, &chunks[j]);
+    }
+
+    MPI_Gatherv(chunks, parts * PARTITION_CHUNK_FLOATS, MPI_FLOAT, all_chunks,
+                chunk_counts, chunk_displs, MPI_FLOAT, 0, comm);
+
+    if (rank == 0) {
+      timer reduced_start, reduced_end;
+      partition_reduce(all_chunks, (size_t)total, reduced->a->data,
+                       reduced->b->data, reduced->c->data, reduced->d->data);
+      failed = pcr(reduced, &reduced_start, &reduced_end) != 0;
+
+      const float *X = reduced->x->data;
+      for (int r = 0, g = 0; r < size; r++) {
+        float *dest = values + value_displs[r];
+        dest[0] = g > 0 ? X[g - 1] : 0.0f;
+        for (int j = 1; j < value_counts[r]; j++, g++) {
+          dest[j] = X[g];
+        }
+      }
+    }
+
+    MPI_Bcast(&failed, 1, MPI_INT, 0, comm);
+  }
+
+  if (!failed) {
+    MPI_Scatterv(values, value_counts, value_displs, MPI_FLOAT, interface,
+                 parts + 1, MPI_FLOAT, 0, comm);
+
+    float *y = coeffs;
+    float *u = coeffs + m;
+    float *v = coeffs + 2 * m;
+    float *x = local->x->data;
+
+#pragma omp parallel for schedule(static)
+    for (int j = 0; j < parts; j++) {
+      const size_t lo = chunk_begin(m, parts, j);
+      const size_t hi = chunk_begin(m, parts, j + 1);
+      partition_substitute(y + lo, u + lo, v + lo, hi - lo, interface[j],
+                           interface[j + 1], x + lo);
+    }
+
+    MPI_Barrier(comm);
+    TIME_GET(*end);
+  }
+
+  if (reduced != NULL) {
+    triSLE_destroy(reduced);
+  }
+  free(values);
+  free(all_chunks);
+  free(value_displs);
+  free(value_counts);
+  free(chunk_displs);
+  free(chunk_counts);
+  free(interface);
+  free(chunks);
+  free(coeffs);
+
+  return failed ? -1 : 0;
+}
@@ -0,0 +1,51 @@
+/**
+ * @file pcr_mpi.h
+ * @brief Distributed solver for tridiagonal systems partitioned over MPI
+ * ranks.
+ *
+ * Kept apart from solver.h so that only MPI programs depend on mpi.h.
+ */
+
+#ifndef PCR_MPI_H
+#define PCR_MPI_H
+
+#include "sle.h"
+#include "util.h"
+
+#include <mpi.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Solve a tridiagonal system distributed over the ranks of comm.
+ *
+ * Every rank holds a consecutive block of rows of the global system as its
+ * own triSLE_t, ordered by rank. a[0] of rank 0 and c[n - 1] of the last rank
+ * are ignored. Each rank splits its block into one chunk per OpenMP thread
+ * and eliminates the chunks in parallel (see partition.h). The resulting
+ * reduced system of one row per chunk is gathered on rank 0 and solved with
+ * pcr(), and the interface values are scattered back for the local
+ * substitution.
+ *
+ * Apart from the reduced system, which is small, no rank ever holds data of
+ * another rank, so the global size is only limited by the aggregate memory.
+ *
+ * @param[in,out] local  Block of this rank, with at least one row. a, b, c
+ *                       and d are not modified; the solution of the block is
+ *                       stored in local->x.
+ * @param[in]     comm   Communicator over which the system is distributed.
+ * @param[out]    start  Timer to record the start time.
+ * @param[out]    end    Timer to record the end time.
+ *
+ * @return 0 on success, non-zero error code on failure. The call is
+ *         collective and returns the same value on every rank.
+ */
+int pcr_mpi(triSLE_t *local, MPI_Comm comm, timer *start, timer *end);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PCR_MPI_H
@@ -0,0 +1,156 @@
+#include "pcr_kernel.h"
+#include "sle_packed.h"
+#include "solver.h"
+#include "util.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#define A(p, i) (p)[TRISLE_PACKED_INDEX(i, 0)]
+#define B(p, i) (p)[TRISLE_PACKED_INDEX(i, 1)]
+#define C(p, i) (p)[TRISLE_PACKED_INDEX(i, 2)]
+#define D(p, i) (p)[TRISLE_PACKED_INDEX(i, 3)]
+
+static inline void packed_update_row(const float *restrict src,
+                                     float *restrict dst, int n, int stride,
+                                     int i) {
+  int iRight = i + stride;
+  int iLeft = i - stride;
+
+  const float alpha =
+      compute_decoupling_coeffs(iLeft < 0 ? 1.f : B(src, iLeft), A(src, i));
+  const float gamma =
+      compute_decoupling_coeffs(iRight < n ? B(src, iRight) : 1.f, C(src, i));
+
+  const float sa_iLeft = iLeft < 0 ? 0.0f : A(src, iLeft);
+  const float sc_iLeft = iLeft < 0 ? 0.0f : C(src, iLeft);
+  const float sd_iLeft = iLeft < 0 ? 0.0f : D(src, iLeft);
+
+  const float sa_iRight = iRight >= n ? 0.0f : A(src, iRight);
+  const float sc_iRight = iRight >= n ? 0.0f : C(src, iRight);
+  const float sd_iRight = iRight >= n ? 0.0f : D(src, iRight);
+
+  A(dst, i) = alpha * sa_iLeft;
+  C(dst, i) = gamma * sc_iRight;
+  B(dst, i) = B(src, i) + alpha * sc_iLeft + gamma * sa_iRight;
+  D(dst, i) = D(src, i) + alpha * sd_iLeft + gamma * sd_iRight;
+}
+
+// Reduce one tile whose neighbours at +-stride are both complete tiles. With
+// stride a multiple of TRISLE_TILE, lane j of the tile only needs lane j of
+// the neighbour tiles, so the loop runs over three contiguous cache lines per
+// coefficient and vectorizes. Clones for wider vector units are selected at
+// load time on x86.
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__)
+__attribute__((target_clones("avx512f", "avx2", "default")))
+#endif
+static void packed_update_tile(const float *restrict tile,
+                                      const float *restrict left,
+                                      const float *restrict right,
+                                      float *restrict out) {
+  const float eps = (float)EPSILON;
+
+  for (int j = 0; j < TRISLE_TILE; j++) {
+    const float b_l = left[TRISLE_TILE + j];
+    const float b_r = right[TRISLE_TILE + j];
+    const float alpha = -tile[j] / (b_l == 0.0f ? eps : b_l);
+    const float gamma = -tile[2 * TRISLE_TILE + j] / (b_r == 0.0f ? eps : b_r);
+
+    out[j] = alpha * left[j];
+    out[2 * TRISLE_TILE + j] = gamma * right[2 * TRISLE_TILE + j];
+    out[TRISLE_TILE + j] = tile[TRISLE_TILE + j] +
+                           alpha * left[2 * TRISLE_TILE + j] +
+                           gamma * right[j];
+    out[3 * TRISLE_TILE + j] = tile[3 * TRISLE_TILE + j] +
+                               alpha * left[3 * TRISLE_TILE + j] +
+                               gamma * right[3 * TRISLE_TILE + j];
+  }
+}
+
+// Assemble the tile of the equations first + offset .. first + offset + 15
+// for an offset that is not a multiple of TRISLE_TILE. Its lanes are split
+// across two neighbouring tiles of src.
+static inline void gather_tile(const float *restrict src, int first,
+                               int offset, float *restrict out) {
+  const int shift = (first + offset) % TRISLE_TILE;
+  const float *lo = src + (size_t)((first + offset) / TRISLE_TILE) *
+                              TRISLE_TILE_FLOATS;
+  const float *hi = lo + TRISLE_TILE_FLOATS;
+
+  for (int k = 0; k < 4; k++) {
+    memcpy(out + k * TRISLE_TILE, lo + k * TRISLE_TILE + shift,
+           (TRISLE_TILE - shift) * sizeof(float));
+    memcpy(out + k * TRISLE_TILE + TRISLE_TILE - shift, hi + k * TRISLE_TILE,
+           shift * sizeof(float));
+  }
+}
+
+static inline void update_step(const float *restrict src, float *restrict dst,
+                               int n, int tiles, int stride) {
+  const int tile_stride = stride / TRISLE_TILE;
+  const int aligned = stride % TRISLE_TILE == 0;
+
+#pragma omp parallel for schedule(static)
+  for (int t = 0; t < tiles; t++) {
+    const int first = t * TRISLE_TILE;
+
+    if (first - stride >= 0 && first + TRISLE_TILE + stride <= n) {
+      const float *tile = src + (size_t)t * TRISLE_TILE_FLOATS;
+      float *out = dst + (size_t)t * TRISLE_TILE_FLOATS;
+
+      if (aligned) {
+        packed_update_tile(tile,
+                           tile - (size_t)tile_stride * TRISLE_TILE_FLOATS,
+                           tile + (size_t)tile_stride * TRISLE_TILE_FLOATS,
+                           out);
+      } else {
+        float left[TRISLE_TILE_FLOATS];
+        float right[TRISLE_TILE_FLOATS];
+        gather_tile(src, first, -stride, left);
+        gather_tile(src, first, stride, right);
+        packed_update_tile(tile, left, right, out);
+      }
+    } else {
+      const int last = first + TRISLE_TILE < n ? first + TRISLE_TILE : n;
+      for (int i = first; i < last; i++) {
+        packed_update_row(src, dst, n, stride, i);
+      }
+    }
+  }
+}
+
+int pcr_packed(triSLE_packed_t *sle, timer *start, timer *end) {
+  if (sle == NULL) {
+    return -1;
+  }
+  size_t n = sle->n;
+  if (n == 0) {
+    return 0; // Nothing to do
+  }
+
+  TIME_GET(*start);
+
+  const size_t total_levels = pcr_total_levels(n);
+
+  // Only the local pointers trade roles, the system keeps owning both sets
+  // of tiles.
+  float *src = sle->data;
+  float *dst = sle->scratch;
+
+  for (size_t level = 0; level < total_levels; level++) {
+    update_step(src, dst, (int)n, (int)sle->tiles, 1 << level);
+
+    float *swap = src;
+    src = dst;
+    dst = swap;
+  }
+
+#pragma omp parallel for schedule(static)
+  for (size_t i = 0; i < n; i++) {
+    sle->x[i] = D(src, i) / B(src, i);
+  }
+
+  TIME_GET(*end);
+
+  return 0;
+}
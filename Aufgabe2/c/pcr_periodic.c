@@ -0,0 +1,226 @@
+#include "factor.h"
+#include "pcr_kernel.h"
+#include "pcr_simd.h"
+#include "sle.h"
+#include "sle_arena.h"
+#include "solver.h"
+#include "util.h"
+#include "workspace.h"
+
+#include <omp.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Reduce row i of a cyclic system, whose size n is a power of two, at the
+// given stride. The neighbours wrap around, so every row has both.
+static inline void periodic_update_row(const float *restrict sa,
+                                       const float *restrict sb,
+                                       const float *restrict sc,
+                                       const float *restrict sd,
+                                       float *restrict ta, float *restrict tb,
+                                       float *restrict tc, float *restrict td,
+                                       int n, int stride, int i) {
+  const int iLeft = (i - stride) & (n - 1);
+  const int iRight = (i + stride) & (n - 1);
+
+  const float alpha = compute_decoupling_coeffs(sb[iLeft], sa[i]);
+  const float gamma = compute_decoupling_coeffs(sb[iRight], sc[i]);
+
+  ta[i] = alpha * sa[iLeft];
+  tc[i] = gamma * sc[iRight];
+  tb[i] = sb[i] + alpha * sc[iLeft] + gamma * sa[iRight];
+  td[i] = sd[i] + alpha * sd[iLeft] + gamma * sd[iRight];
+}
+
+// Reduce rows [lo, hi) of a cyclic system. Rows whose neighbours do not
+// wrap around are reduced exactly as in a non-periodic system, so they go
+// through the SIMD kernel.
+static inline void periodic_update_range(pcr_update_range_fn kernel,
+                                         const float *sa, const float *sb,
+                                         const float *sc, const float *sd,
+                                         float *ta, float *tb, float *tc,
+                                         float *td, int n, int stride, int lo,
+                                         int hi) {
+  int ilo = lo > stride ? lo : stride;
+  int ihi = hi < n - stride ? hi : n - stride;
+  if (ihi < ilo) {
+    ilo = ihi = hi;
+  }
+
+  for (int i = lo; i < ilo; i++) {
+    periodic_update_row(sa, sb, sc, sd, ta, tb, tc, td, n, stride, i);
+  }
+  kernel(sa, sb, sc, sd, ta, tb, tc, td, n, stride, ilo, ihi);
+  for (int i = ihi; i < hi; i++) {
+    periodic_update_row(sa, sb, sc, sd, ta, tb, tc, td, n, stride, i);
+  }
+}
+
+// Cyclic reduction of a system whose size n >= 2 is a power of two. After
+// log2(n) - 1 levels, rows i and j = i + n / 2 (mod n) only couple to each
+// other, both neighbours of one being the other, and form a 2x2 system.
+static void solve_power_of_two(pcr_update_range_fn kernel, float *sa,
+                               float *sb, float *sc, float *sd, float *ta,
+                               float *tb, float *tc, float *td,
+                               float *restrict x, int n) {
+  const size_t total_levels = pcr_total_levels((size_t)n);
+
+#pragma omp parallel firstprivate(sa, sb, sc, sd, ta, tb, tc, td)
+  {
+    int lo, hi;
+    pcr_thread_range(n, omp_get_thread_num(), omp_get_num_threads(), &lo,
+                     &hi);
+
+    for (size_t level = 0; level + 1 < total_levels; level++) {
+      periodic_update_range(kernel, sa, sb, sc, sd, ta, tb, tc, td, n,
+                            1 << level, lo, hi);
+#pragma omp barrier
+
+      float *swap;
+      swap = sa, sa = ta, ta = swap;
+      swap = sb, sb = tb, tb = swap;
+      swap = sc, sc = tc, tc = swap;
+      swap = sd, sd = td, td = swap;
+    }
+
+    const int half = n / 2;
+    for (int i = lo; i < hi; i++) {
+      const int j = (i + half) & (n - 1);
+      const float ei = sa[i] + sc[i];
+      const float ej = sa[j] + sc[j];
+      x[i] = (sb[j] * sd[i] - ei * sd[j]) / (sb[i] * sb[j] - ei * ej);
+    }
+  }
+}
+
+// Sherman-Morrison for any other n >= 2: A = A' + u v^T with the
+// non-periodic matrix A', u = (g, 0, ..., 0, c[n - 1]) and
+// v = (1, 0, ..., 0, a[0] / g), g = -b[0]. A' is factorized once and solved
+// for d and u together.
+static int solve_sherman_morrison(triSLE_t *sle) {
+  const int n = (int)sle->b->n;
+  const float *a = sle->a->data;
+  const float *b = sle->b->data;
+  const float *c = sle->c->data;
+  const float *d = sle->d->data;
+  float *x = sle->x->data;
+
+  const float g = b[0] != 0.0f ? -b[0] : -1.0f;
+  const float v_last = a[0] / g;
+
+  triSLE_t *modified = NULL;
+  pcr_workspace_t *ws = NULL;
+  pcr_factor_t *factor = NULL;
+  float *rhs = (float *)malloc(2 * (size_t)n * sizeof(float));
+  float *scratch = (float *)malloc(2 * (size_t)n * sizeof(float));
+  float *yz = (float *)malloc(2 * (size_t)n * sizeof(float));
+  int ret = -1;
+
+  if (rhs == NULL || scratch == NULL || yz == NULL ||
+      triSLE_arena_create(&modified, n, 0) != 0 ||
+      pcr_workspace_create(&ws, n) != 0 || pcr_factor_create(&factor, n) != 0) {
+    goto cleanup; // Memory allocation failed
+  }
+
+  memcpy(modified->a->data, a, (size_t)n * sizeof(float));
+  memcpy(modified->b->data, b, (size_t)n * sizeof(float));
+  memcpy(modified->c->data, c, (size_t)n * sizeof(float));
+  modified->a->data[0] = 0.0f;
+  modified->c->data[n - 1] = 0.0f;
+  modified->b->data[0] -= g;
+  modified->b->data[n - 1] -= c[n - 1] * v_last;
+
+  // rhs holds d and u interleaved, as pcr_factor_solve() expects
+#pragma omp parallel for schedule(static)
+  for (int i = 0; i < n; i++) {
+    rhs[2 * i] = d[i];
+    rhs[2 * i + 1] = 0.0f;
+  }
+  rhs[1] = g;
+  rhs[2 * (n - 1) + 1] = c[n - 1];
+
+  timer start, end;
+  if (pcr_factorize(modified, ws, factor, &start, &end) != 0 ||
+      pcr_factor_solve(factor, rhs, scratch, yz, 2, &start, &end) != 0) {
+    goto cleanup;
+  }
+
+  const float vy = yz[0] + v_last * yz[2 * (n - 1)];
+  const float vz = yz[1] + v_last * yz[2 * (n - 1) + 1];
+  const float scale = vy / (1.0f + vz);
+
+#pragma omp parallel for schedule(static)
+  for (int i = 0; i < n; i++) {
+    x[i] = yz[2 * i] - scale * yz[2 * i + 1];
+  }
+  ret = 0; // Success
+
+cleanup:
+  if (factor != NULL) {
+    pcr_factor_destroy(factor);
+  }
+  if (ws != NULL) {
+    pcr_workspace_destroy(ws);
+  }
+  if (modified != NULL) {
+    triSLE_arena_destroy(modified);
+  }
+  free(rhs);
+  free(scratch);
+  free(yz);
+  return ret;
+}
+
+int pcr_periodic(triSLE_t *sle, timer *start, timer *end) {
+  if (sle == NULL) {
+    return -1;
+  }
+  size_t n = sle->b->n;
+  if (n == 0) {
+    return 0; // Nothing to do
+  }
+
+  TIME_GET(*start);
+
+  if (n == 1) {
+    // Both neighbours of the only row are the row itself
+    sle->x->data[0] = sle->d->data[0] /
+                      (sle->a->data[0] + sle->b->data[0] + sle->c->data[0]);
+    TIME_GET(*end);
+    return 0;
+  }
+
+  if ((n & (n - 1)) != 0) {
+    const int ret = solve_sherman_morrison(sle);
+    TIME_GET(*end);
+    return ret;
+  }
+
+  float *a_data_tmp = (float *)malloc(n * sizeof(float));
+  float *b_data_tmp = (float *)malloc(n * sizeof(float));
+  float *c_data_tmp = (float *)malloc(n * sizeof(float));
+  float *d_data_tmp = (float *)malloc(n * sizeof(float));
+
+  if (a_data_tmp == NULL || b_data_tmp == NULL || c_data_tmp == NULL ||
+      d_data_tmp == NULL) {
+    free(a_data_tmp);
+    free(b_data_tmp);
+    free(c_data_tmp);
+    free(d_data_tmp);
+    return -1; // Memory allocation failure
+  }
+
+  solve_power_of_two(pcr_update_range_select(), sle->a->data, sle->b->data,
+                     sle->c->data, sle->d->data, a_data_tmp, b_data_tmp,
+                     c_data_tmp, d_data_tmp, sle->x->data, (int)n);
+
+  TIME_GET(*end);
+
+  free(a_data_tmp);
+  free(b_data_tmp);
+  free(c_data_tmp);
+  free(d_data_tmp);
+
+  return 0;
+}
@@ -0,0 +1,583 @@
+#include "pcr_simd.h"
+#include "pcr_kernel.h"
+#include "solver.h"
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PCR_HAVE_X86 1
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define PCR_HAVE_NEON 1
+#endif
+
+// Split [lo, hi) into the interior part [*ilo, *ihi), where both neighbours
+// exist, and the boundary rows around it.
+static inline void interior_range(int n, int stride, int lo, int hi, int *ilo,
+                                  int *ihi) {
+  *ilo = lo > stride ? lo : stride;
+  *ihi = hi < n - stride ? hi : n - stride;
+  if (*ihi < *ilo) {
+    *ilo = *ihi = hi;
+  }
+}
+
+static inline void update_rows_scalar(const float *sa, const float *sb,
+                                      const float *sc, const float *sd,
+                                      float *tmp_a, float *tmp_b, float *tmp_c,
+                                      float *tmp_d, int n, int stride, int lo,
+                                      int hi) {
+  for (int i = lo; i < hi; i++) {
+    pcr_update_row(sa, sb, sc, sd, tmp_a, tmp_b, tmp_c, tmp_d, n, stride, i);
+  }
+}
+
+static void update_range_scalar(const float *sa, const float *sb,
+                                const float *sc, const float *sd, float *tmp_a,
+                                float *tmp_b, float *tmp_c, float *tmp_d,
+                                int n, int stride, int lo, int hi) {
+  update_rows_scalar(sa, sb, sc, sd, tmp_a, tmp_b, tmp_c, tmp_d, n, stride, lo,
+                     hi);
+}
+
+// Reciprocal without a division: the estimate from subtracting the bits from
+// a magic constant is within 5 % and three Newton steps r (2 - v r) refine it
+// to about one unit in the last place. Zero is replaced by EPSILON as in
+// compute_decoupling_coeffs().
+static inline float reciprocal_scalar(float value) {
+  if (value == 0.0f) {
+    value = (float)EPSILON;
+  }
+
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  bits = (0x7EF311C3u - (bits & 0x7FFFFFFFu)) | (bits & 0x80000000u);
+
+  float r;
+  memcpy(&r, &bits, sizeof(r));
+  for (int step = 0; step < 3; step++) {
+    r = r * (2.0f - value * r);
+  }
+  return r;
+}
+
+// Division-free pcr_update_row(): alpha and gamma multiply by the reciprocals
+// of the neighbouring b. With x != NULL, the level is the last one and
+// x[i] = d' / b' is written instead of the reduced equation.
+static inline void update_row_rcp_scalar(const float *sa, const float *sb,
+                                         const float *sc, const float *sd,
+                                         float *tmp_a, float *tmp_b,
+                                         float *tmp_c, float *tmp_d, float *x,
+                                         int n, int stride, int i) {
+  const int iRight = i + stride;
+  const int iLeft = i - stride;
+
+  const float alpha =
+      -sa[i] * (iLeft < 0 ? 1.0f : reciprocal_scalar(sb[iLeft]));
+  const float gamma =
+      -sc[i] * (iRight < n ? reciprocal_scalar(sb[iRight]) : 1.0f);
+
+  const float sa_iLeft = iLeft < 0 ? 0.0f : sa[iLeft];
+  const float sc_iLeft = iLeft < 0 ? 0.0f : sc[iLeft];
+  const float sd_iLeft = iLeft < 0 ? 0.0f : sd[iLeft];
+
+  const float sa_iRight = iRight >= n ? 0.0f : sa[iRight];
+  const float sc_iRight = iRight >= n ? 0.0f : sc[iRight];
+  const float sd_iRight = iRight >= n ? 0.0f : sd[iRight];
+
+  const float b = sb[i] + alpha * sc_iLeft + gamma * sa_iRight;
+  const float d = sd[i] + alpha * sd_iLeft + gamma * sd_iRight;
+
+  if (x != NULL) {
+    x[i] = d * reciprocal_scalar(b);
+    return;
+  }
+
+  tmp_a[i] = alpha * sa_iLeft;
+  tmp_c[i] = gamma * sc_iRight;
+  tmp_b[i] = b;
+  tmp_d[i] = d;
+}
+
+static inline void update_rows_rcp_scalar(const float *sa, const float *sb,
+                                          const float *sc, const float *sd,
+                                          float *tmp_a, float *tmp_b,
+                                          float *tmp_c, float *tmp_d, float *x,
+                                          int n, int stride, int lo, int hi) {
+  for (int i = lo; i < hi; i++) {
+    update_row_rcp_scalar(sa, sb, sc, sd, tmp_a, tmp_b, tmp_c, tmp_d, x, n,
+                          stride, i);
+  }
+}
+
+static void update_range_rcp_scalar(const float *sa, const float *sb,
+                                    const float *sc, const float *sd,
+                                    float *tmp_a, float *tmp_b, float *tmp_c,
+                                    float *tmp_d, float *x, int n, int stride,
+                                    int lo, int hi) {
+  update_rows_rcp_scalar(sa, sb, sc, sd, tmp_a, tmp_b, tmp_c, tmp_d, x, n,
+                         stride, lo, hi);
+}
+
+#if defined(PCR_HAVE_X86)
+__attribute__((target("avx2,fma"))) static void
+update_range_avx2(const float *sa, const float *sb, const float *sc,
+                  const float *sd, float *tmp_a, float *tmp_b, float *tmp_c,
+                  float *tmp_d, int n, int stride, int lo, int hi) {
+  int ilo, ihi;
+  interior_range(n, stride, lo, hi, &ilo, &ihi);
+
+  update_rows_scalar(sa, sb, sc, sd, tmp_a, tmp_b, tmp_c, tmp_d, n, stride, lo,
+                     ilo);
+
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 eps = _mm256_set1_ps((float)EPSILON);
+
+  int i = ilo;
+  for (; i + 8 <= ihi; i += 8) {
+    const int l = i - stride;
+    const int r = i + stride;
+
+    __m256 b_l = _mm256_loadu_ps(sb + l);
+    __m256 b_r = _mm256_loadu_ps(sb + r);
+    b_l = _mm256_blendv_ps(b_l, eps, _mm256_cmp_ps(b_l, zero, _CMP_EQ_OQ));
+    b_r = _mm256_blendv_ps(b_r, eps, _mm256_cmp_ps(b_r, zero, _CMP_EQ_OQ));
+
+    const __m256 alpha =
+        _mm256_div_ps(_mm256_sub_ps(zero, _mm256_loadu_ps(sa + i)), b_l);
+    const __m256 gamma =
+        _mm256_div_ps(_mm256_sub_ps(zero, _mm256_loadu_ps(sc + i)), b_r);
+
+    _mm256_storeu_ps(tmp_a + i, _mm256_mul_ps(alpha, _mm256_loadu_ps(sa + l)));
+    _mm256_storeu_ps(tmp_c + i, _mm256_mul_ps(gamma, _mm256_loadu_ps(sc + r)));
+    _mm256_storeu_ps(
+        tmp_b + i,
+        _mm256_fmadd_ps(gamma, _mm256_loadu_ps(sa + r),
+                        _mm256_fmadd_ps(alpha, _mm256_loadu_ps(sc + l),
+                                        _mm256_loadu_ps(sb + i))));
+    _mm256_storeu_ps(
+        tmp_d + i,
+        _mm256_fmadd_ps(gamma, _mm256_loadu_ps(sd + r),
+                        _mm256_fmadd_ps(alpha, _mm256_loadu_ps(sd + l),
+                                        _mm256_loadu_ps(sd + i))));
+  }
+
+  update_rows_scalar(sa, sb, sc, sd, tmp_a, tmp_b, tmp_c, tmp_d, n, stride, i,
+                     hi);
+}
+
+__attribute__((target("avx512f"))) static void
+update_range_avx512(const float *sa, const float *sb, const float *sc,
+                    const float *sd, float *tmp_a, float *tmp_b, float *tmp_c,
+                    float *tmp_d, int n, int stride, int lo, int hi) {
+  int ilo, ihi;
+  interior_range(n, stride, lo, hi, &ilo, &ihi);
+
+  update_rows_scalar(sa, sb, sc, sd, tmp_a, tmp_b, tmp_c, tmp_d, n, stride, lo,
+                     ilo);
+
+  const __m512 zero = _mm512_setzero_ps();
+  const __m512 eps = _mm512_set1_ps((float)EPSILON);
+
+  int i = ilo;
+  for (; i + 16 <= ihi; i += 16) {
+    const int l = i - stride;
+    const int r = i + stride;
+
+    __m512 b_l = _mm512_loadu_ps(sb + l);
+    __m512 b_r = _mm512_loadu_ps(sb + r);
+    b_l = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(b_l, zero, _CMP_EQ_OQ), b_l,
+                               eps);
+    b_r = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(b_r, zero, _CMP_EQ_OQ), b_r,
+                               eps);
+
+    const __m512 alpha =
+        _mm512_div_ps(_mm512_sub_ps(zero, _mm512_loadu_ps(sa + i)), b_l);
+    const __m512 gamma =
+        _mm512_div_ps(_mm512_sub_ps(zero, _mm512_loadu_ps(sc + i)), b_r);
+
+    _mm512_storeu_ps(tmp_a + i, _mm512_mul_ps(alpha, _mm512_loadu_ps(sa + l)));
+    _mm512_storeu_ps(tmp_c + i, _mm512_mul_ps(gamma, _mm512_loadu_ps(sc + r)));
+    _mm512_storeu_ps(
+        tmp_b + i,
+        _mm512_fmadd_ps(gamma, _mm512_loadu_ps(sa + r),
+                        _mm512_fmadd_ps(alpha, _mm512_loadu_ps(sc + l),
+                                        _mm512_loadu_ps(sb + i))));
+    _mm512_storeu_ps(
+        tmp_d + i,
+        _mm512_fmadd_ps(gamma, _mm512_loadu_ps(sd + r),
+                        _mm512_fmadd_ps(alpha, _mm512_loadu_ps(sd + l),
+                                        _mm512_loadu_ps(sd + i))));
+  }
+
+  update_rows_scalar(sa, sb, sc, sd, tmp_a, tmp_b, tmp_c, tmp_d, n, stride, i,
+                     hi);
+}
+// Approximate reciprocal (12 bits) refined by one Newton step r (2 - b r) to
+// about 23 bits. Zero is replaced by EPSILON.
+__attribute__((target("avx2,fma"))) static inline __m256
+reciprocal_avx2(__m256 b) {
+  b = _mm256_blendv_ps(b, _mm256_set1_ps((float)EPSILON),
+                       _mm256_cmp_ps(b, _mm256_setzero_ps(), _CMP_EQ_OQ));
+  const __m256 r = _mm256_rcp_ps(b);
+  return _mm256_mul_ps(r, _mm256_fnmadd_ps(b, r, _mm256_set1_ps(2.0f)));
+}
+
+// Load 8 floats, or with full == 0 only the lanes of mask and zero otherwise.
+// full is a constant at every call site, so the interior uses plain loads.
+__attribute__((target("avx2,fma"))) static inline __m256
+load_avx2(const float *p, __m256i mask, int full) {
+  return full ? _mm256_loadu_ps(p) : _mm256_maskload_ps(p, mask);
+}
+
+__attribute__((target("avx2,fma"))) static inline void
+store_avx2(float *p, __m256i mask, int full, __m256 v) {
+  if (full) {
+    _mm256_storeu_ps(p, v);
+  } else {
+    _mm256_maskstore_ps(p, mask, v);
+  }
+}
+
+// Division-free reduction of the 8 rows from i. Only the lanes of `lanes`
+// are read and written; neighbours outside `left` and `right` are the
+// identity equation, as in pcr_update_row(). With full != 0 all three masks
+// must be complete.
+__attribute__((target("avx2,fma"))) static inline void
+update_rcp_avx2(const float *sa, const float *sb, const float *sc,
+                const float *sd, float *tmp_a, float *tmp_b, float *tmp_c,
+                float *tmp_d, float *x, int stride, int i, __m256i lanes,
+                __m256i left, __m256i right, int full) {
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 one = _mm256_set1_ps(1.0f);
+  const int l = i - stride;
+  const int r = i + stride;
+
+  __m256 b_l = load_avx2(sb + l, left, full);
+  __m256 b_r = load_avx2(sb + r, right, full);
+  if (!full) {
+    b_l = _mm256_blendv_ps(one, b_l, _mm256_castsi256_ps(left));
+    b_r = _mm256_blendv_ps(one, b_r, _mm256_castsi256_ps(right));
+  }
+
+  const __m256 alpha =
+      _mm256_mul_ps(_mm256_sub_ps(zero, load_avx2(sa + i, lanes, full)),
+                    reciprocal_avx2(b_l));
+  const __m256 gamma =
+      _mm256_mul_ps(_mm256_sub_ps(zero, load_avx2(sc + i, lanes, full)),
+                    reciprocal_avx2(b_r));
+
+  const __m256 b =
+      _mm256_fmadd_ps(gamma, load_avx2(sa + r, right, full),
+                      _mm256_fmadd_ps(alpha, load_avx2(sc + l, left, full),
+                                      load_avx2(sb + i, lanes, full)));
+  const __m256 d =
+      _mm256_fmadd_ps(gamma, load_avx2(sd + r, right, full),
+                      _mm256_fmadd_ps(alpha, load_avx2(sd + l, left, full),
+                                      load_avx2(sd + i, lanes, full)));
+
+  if (x != NULL) {
+    store_avx2(x + i, lanes, full, _mm256_mul_ps(d, reciprocal_avx2(b)));
+    return;
+  }
+
+  store_avx2(tmp_a + i, lanes, full,
+             _mm256_mul_ps(alpha, load_avx2(sa + l, left, full)));
+  store_avx2(tmp_c + i, lanes, full,
+             _mm256_mul_ps(gamma, load_avx2(sc + r, right, full)));
+  store_avx2(tmp_b + i, lanes, full, b);
+  store_avx2(tmp_d + i, lanes, full, d);
+}
+
+// Masked step for the rows [i, min(i + 8, end)), the boundary rows and the
+// remainder of the interior.
+__attribute__((target("avx2,fma"))) static inline void
+update_rcp_masked_avx2(const float *sa, const float *sb, const float *sc,
+                       const float *sd, float *tmp_a, float *tmp_b,
+                       float *tmp_c, float *tmp_d, float *x, int n, int stride,
+                       int i, int end) {
+  const __m256i idx = _mm256_add_epi32(
+      _mm256_set1_epi32(i), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+  const __m256i lanes = _mm256_cmpgt_epi32(_mm256_set1_epi32(end), idx);
+  const __m256i left = _mm256_and_si256(
+      lanes, _mm256_cmpgt_epi32(idx, _mm256_set1_epi32(stride - 1)));
+  const __m256i right = _mm256_and_si256(
+      lanes, _mm256_cmpgt_epi32(_mm256_set1_epi32(n - stride), idx));
+
+  update_rcp_avx2(sa, sb, sc, sd, tmp_a, tmp_b, tmp_c, tmp_d, x, stride, i,
+                  lanes, left, right, 0);
+}
+
+__attribute__((target("avx2,fma"))) static void
+update_range_rcp_avx2(const float *sa, const float *sb, const float *sc,
+                      const float *sd, float *tmp_a, float *tmp_b,
+                      float *tmp_c, float *tmp_d, float *x, int n, int stride,
+                      int lo, int hi) {
+  int ilo, ihi;
+  interior_range(n, stride, lo, hi, &ilo, &ihi);
+
+  const __m256i all = _mm256_set1_epi32(-1);
+
+  int i = lo;
+  for (; i < ilo; i += 8) {
+    update_rcp_masked_avx2(sa, sb, sc, sd, tmp_a, tmp_b, tmp_c, tmp_d, x, n,
+                           stride, i, ilo);
+  }
+  for (i = ilo; i + 8 <= ihi; i += 8) {
+    update_rcp_avx2(sa, sb, sc, sd, tmp_a, tmp_b, tmp_c, tmp_d, x, stride, i,
+                    all, all, all, 1);
+  }
+  for (; i < hi; i += 8) {
+    update_rcp_masked_avx2(sa, sb, sc, sd, tmp_a, tmp_b, tmp_c, tmp_d, x, n,
+                           stride, i, hi);
+  }
+}
+
+// Approximate reciprocal (14 bits) refined by one Newton step to full
+// single precision. Zero is replaced by EPSILON.
+__attribute__((target("avx512f"))) static inline __m512
+reciprocal_avx512(__m512 b) {
+  b = _mm512_mask_blend_ps(
+      _mm512_cmp_ps_mask(b, _mm512_setzero_ps(), _CMP_EQ_OQ), b,
+      _mm512_set1_ps((float)EPSILON));
+  const __m512 r = _mm512_rcp14_ps(b);
+  return _mm512_mul_ps(r, _mm512_fnmadd_ps(b, r, _mm512_set1_ps(2.0f)));
+}
+
+// Division-free reduction of the rows [i, min(i + 16, end)). Masked loads
+// read the identity equation for neighbours outside the system and never
+// touch memory outside the masks, so boundary rows and the remainder take
+// the same path as the interior.
+__attribute__((target("avx512f"))) static inline void
+update_rcp_avx512(const float *sa, const float *sb, const float *sc,
+                  const float *sd, float *tmp_a, float *tmp_b, float *tmp_c,
+                  float *tmp_d, float *x, int n, int stride, int i, int end) {
+  const __m512 zero = _mm512_setzero_ps();
+  const __m512 one = _mm512_set1_ps(1.0f);
+  const int l = i - stride;
+  const int r = i + stride;
+
+  const __m512i idx = _mm512_add_epi32(
+      _mm512_set1_epi32(i), _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9,
+                                              10, 11, 12, 13, 14, 15));
+  const __mmask16 lanes = _mm512_cmplt_epi32_mask(idx, _mm512_set1_epi32(end));
+  const __mmask16 left =
+      lanes & _mm512_cmpge_epi32_mask(idx, _mm512_set1_epi32(stride));
+  const __mmask16 right =
+      lanes & _mm512_cmplt_epi32_mask(idx, _mm512_set1_epi32(n - stride));
+
+  const __m512 alpha =
+      _mm512_mul_ps(_mm512_sub_ps(zero, _mm512_maskz_loadu_ps(lanes, sa + i)),
+                    reciprocal_avx512(_mm512_mask_loadu_ps(one, left, sb + l)));
+  const __m512 gamma = _mm512_mul_ps(
+      _mm512_sub_ps(zero, _mm512_maskz_loadu_ps(lanes, sc + i)),
+      reciprocal_avx512(_mm512_mask_loadu_ps(one, right, sb + r)));
+
+  const __m512 b = _mm512_fmadd_ps(
+      gamma, _mm512_maskz_loadu_ps(right, sa + r),
+      _mm512_fmadd_ps(alpha, _mm512_maskz_loadu_ps(left, sc + l),
+                      _mm512_maskz_loadu_ps(lanes, sb + i)));
+  const __m512 d = _mm512_fmadd_ps(
+      gamma, _mm512_maskz_loadu_ps(right, sd + r),
+      _mm512_fmadd_ps(alpha, _mm512_maskz_loadu_ps(left, sd + l),
+                      _mm512_maskz_loadu_ps(lanes, sd + i)));
+
+  if (x != NULL) {
+    _mm512_mask_storeu_ps(x + i, lanes, _mm512_mul_ps(d, reciprocal_avx512(b)));
+    return;
+  }
+
+  _mm512_mask_storeu_ps(
+      tmp_a + i, lanes,
+      _mm512_mul_ps(alpha, _mm512_maskz_loadu_ps(left, sa + l)));
+  _mm512_mask_storeu_ps(
+      tmp_c + i, lanes,
+      _mm512_mul_ps(gamma, _mm512_maskz_loadu_ps(right, sc + r)));
+  _mm512_mask_storeu_ps(tmp_b + i, lanes, b);
+  _mm512_mask_storeu_ps(tmp_d + i, lanes, d);
+}
+
+__attribute__((target("avx512f"))) static void
+update_range_rcp_avx512(const float *sa, const float *sb, const float *sc,
+                        const float *sd, float *tmp_a, float *tmp_b,
+                        float *tmp_c, float *tmp_d, float *x, int n,
+                        int stride, int lo, int hi) {
+  for (int i = lo; i < hi; i += 16) {
+    update_rcp_avx512(sa, sb, sc, sd, tmp_a, tmp_b, tmp_c, tmp_d, x, n, stride,
+                      i, hi);
+  }
+}
+#endif // PCR_HAVE_X86
+
+#if defined(PCR_HAVE_NEON)
+static void update_range_neon(const float *sa, const float *sb,
+                              const float *sc, const float *sd, float *tmp_a,
+                              float *tmp_b, float *tmp_c, float *tmp_d, int n,
+                              int stride, int lo, int hi) {
+  int ilo, ihi;
+  interior_range(n, stride, lo, hi, &ilo, &ihi);
+
+  update_rows_scalar(sa, sb, sc, sd, tmp_a, tmp_b, tmp_c, tmp_d, n, stride, lo,
+                     ilo);
+
+  const float32x4_t zero = vdupq_n_f32(0.0f);
+  const float32x4_t eps = vdupq_n_f32((float)EPSILON);
+
+  int i = ilo;
+  for (; i + 4 <= ihi; i += 4) {
+    const int l = i - stride;
+    const int r = i + stride;
+
+    float32x4_t b_l = vld1q_f32(sb + l);
+    float32x4_t b_r = vld1q_f32(sb + r);
+    b_l = vbslq_f32(vceqq_f32(b_l, zero), eps, b_l);
+    b_r = vbslq_f32(vceqq_f32(b_r, zero), eps, b_r);
+
+    const float32x4_t alpha = vdivq_f32(vnegq_f32(vld1q_f32(sa + i)), b_l);
+    const float32x4_t gamma = vdivq_f32(vnegq_f32(vld1q_f32(sc + i)), b_r);
+
+    vst1q_f32(tmp_a + i, vmulq_f32(alpha, vld1q_f32(sa + l)));
+    vst1q_f32(tmp_c + i, vmulq_f32(gamma, vld1q_f32(sc + r)));
+    vst1q_f32(tmp_b + i,
+              vfmaq_f32(vfmaq_f32(vld1q_f32(sb + i), alpha, vld1q_f32(sc + l)),
+                        gamma, vld1q_f32(sa + r)));
+    vst1q_f32(tmp_d + i,
+              vfmaq_f32(vfmaq_f32(vld1q_f32(sd + i), alpha, vld1q_f32(sd + l)),
+                        gamma, vld1q_f32(sd + r)));
+  }
+
+  update_rows_scalar(sa, sb, sc, sd, tmp_a, tmp_b, tmp_c, tmp_d, n, stride, i,
+                     hi);
+}
+// Approximate reciprocal (8 bits) refined by two Newton steps. Zero is
+// replaced by EPSILON.
+static inline float32x4_t reciprocal_neon(float32x4_t b) {
+  b = vbslq_f32(vceqq_f32(b, vdupq_n_f32(0.0f)), vdupq_n_f32((float)EPSILON),
+                b);
+  float32x4_t r = vrecpeq_f32(b);
+  r = vmulq_f32(r, vrecpsq_f32(b, r));
+  return vmulq_f32(r, vrecpsq_f32(b, r));
+}
+
+static void update_range_rcp_neon(const float *sa, const float *sb,
+                                  const float *sc, const float *sd,
+                                  float *tmp_a, float *tmp_b, float *tmp_c,
+                                  float *tmp_d, float *x, int n, int stride,
+                                  int lo, int hi) {
+  int ilo, ihi;
+  interior_range(n, stride, lo, hi, &ilo, &ihi);
+
+  // NEON has no masked loads; the boundary rows use the scalar reciprocal.
+  update_rows_rcp_scalar(sa, sb, sc, sd, tmp_a, tmp_b, tmp_c, tmp_d, x, n,
+                         stride, lo, ilo);
+
+  int i = ilo;
+  for (; i + 4 <= ihi; i += 4) {
+    const int l = i - stride;
+    const int r = i + stride;
+
+    const float32x4_t alpha = vmulq_f32(vnegq_f32(vld1q_f32(sa + i)),
+                                        reciprocal_neon(vld1q_f32(sb + l)));
+    const float32x4_t gamma = vmulq_f32(vnegq_f32(vld1q_f32(sc + i)),
+                                        reciprocal_neon(vld1q_f32(sb + r)));
+
+    const float32x4_t b =
+        vfmaq_f32(vfmaq_f32(vld1q_f32(sb + i), alpha, vld1q_f32(sc + l)),
+                  gamma, vld1q_f32(sa + r));
+    const float32x4_t d =
+        vfmaq_f32(vfmaq_f32(vld1q_f32(sd + i), alpha, vld1q_f32(sd + l)),
+                  gamma, vld1q_f32(sd + r));
+
+    if (x != NULL) {
+      vst1q_f32(x + i, vmulq_f32(d, reciprocal_neon(b)));
+      continue;
+    }
+
+    vst1q_f32(tmp_a + i, vmulq_f32(alpha, vld1q_f32(sa + l)));
+    vst1q_f32(tmp_c + i, vmulq_f32(gamma, vld1q_f32(sc + r)));
+    vst1q_f32(tmp_b + i, b);
+    vst1q_f32(tmp_d + i, d);
+  }
+
+  update_rows_rcp_scalar(sa, sb, sc, sd, tmp_a, tmp_b, tmp_c, tmp_d, x, n,
+                         stride, i, hi);
+}
+#endif // PCR_HAVE_NEON
+
+struct kernel_entry {
+  const char *name;
+  pcr_update_range_fn fn;
+  pcr_update_range_rcp_fn rcp;
+  int (*supported)(void);
+};
+
+static int always_supported(void) { return 1; }
+
+#if defined(PCR_HAVE_X86)
+static int avx2_supported(void) {
+  return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+}
+
+static int avx512_supported(void) { return __builtin_cpu_supports("avx512f"); }
+#endif
+
+// Ordered from the most to the least preferred kernel.
+static const struct kernel_entry kernels[] = {
+#if defined(PCR_HAVE_X86)
+    {"avx512", update_range_avx512, update_range_rcp_avx512,
+     avx512_supported},
+    {"avx2", update_range_avx2, update_range_rcp_avx2, avx2_supported},
+#endif
+#if defined(PCR_HAVE_NEON)
+    {"neon", update_range_neon, update_range_rcp_neon, always_supported},
+#endif
+    {"scalar", update_range_scalar, update_range_rcp_scalar,
+     always_supported},
+};
+
+static const struct kernel_entry *selected = NULL;
+static pthread_once_t selected_once = PTHREAD_ONCE_INIT;
+
+static void init_selected(void) {
+  const size_t count = sizeof(kernels) / sizeof(kernels[0]);
+  const struct kernel_entry *choice = NULL;
+
+  const char *request = getenv("PCR_SIMD");
+  for (size_t k = 0; request != NULL && k < count; k++) {
+    if (strcmp(request, kernels[k].name) == 0 && kernels[k].supported()) {
+      choice = &kernels[k];
+    }
+  }
+
+  for (size_t k = 0; choice == NULL && k < count; k++) {
+    if (kernels[k].supported()) {
+      choice = &kernels[k];
+    }
+  }
+
+  selected = choice;
+}
+
+// The solvers may be entered from several threads at once (pcr_async.h,
+// parallel regions), so the choice is made exactly once.
+static const struct kernel_entry *select_kernel(void) {
+  pthread_once(&selected_once, init_selected);
+  return selected;
+}
+
+pcr_update_range_fn pcr_update_range_select(void) {
+  return select_kernel()->fn;
+}
+
+pcr_update_range_rcp_fn pcr_update_range_rcp_select(void) {
+  return select_kernel()->rcp;
+}
+
+const char *pcr_kernel_name(void) { return select_kernel()->name; }
@@ -0,0 +1,54 @@
+/**
+ * @file pcr_simd.h
+ * @brief Internal vectorized reduction kernels for the CPU PCR solvers.
+ *
+ * A kernel reduces a contiguous range of equations of one level. The boundary
+ * equations, whose neighbours lie outside the system, are handled by the
+ * scalar pcr_update_row(); the interior runs branch-free with wide loads and
+ * FMA. The widest kernel supported by the CPU is selected at runtime.
+ */
+
+#ifndef PCR_SIMD_H
+#define PCR_SIMD_H
+
+/**
+ * @brief Reduce the equations [lo, hi) of a system with n equations.
+ */
+typedef void (*pcr_update_range_fn)(const float *sa, const float *sb,
+                                    const float *sc, const float *sd,
+                                    float *tmp_a, float *tmp_b, float *tmp_c,
+                                    float *tmp_d, int n, int stride, int lo,
+                                    int hi);
+
+/**
+ * @brief Return the reduction kernel for this CPU.
+ *
+ * The choice is made on the first call using CPU feature detection and can be
+ * overridden with the environment variable PCR_SIMD (scalar, neon, avx2 or
+ * avx512). Unsupported requests fall back to the automatic choice.
+ */
+pcr_update_range_fn pcr_update_range_select(void);
+
+/**
+ * @brief Division-free reduction of the equations [lo, hi).
+ *
+ * Reads and writes the same arrays as pcr_update_range_fn. The reciprocals of
+ * the neighbouring b are recomputed in registers from an approximation
+ * refined with Newton's method, so no reciprocal array adds to the traffic.
+ * With x != NULL, the level is the last one and x = d' / b' is written,
+ * again through a reciprocal, instead of tmp_a..tmp_d. No row divides.
+ */
+typedef void (*pcr_update_range_rcp_fn)(const float *sa, const float *sb,
+                                        const float *sc, const float *sd,
+                                        float *tmp_a, float *tmp_b,
+                                        float *tmp_c, float *tmp_d, float *x,
+                                        int n, int stride, int lo, int hi);
+
+/**
+ * @brief Return the division-free reduction kernel for this CPU.
+ *
+ * Uses the same instruction set as pcr_update_range_select().
+ */
+pcr_update_range_rcp_fn pcr_update_range_rcp_select(void);
+
+#endif // PCR_SIMD_H
@@ -0,0 +1,275 @@
+#include "partition.h"
+#include "sle.h"
+#include "sle_io.h"
+#include "solver.h"
+#include "util.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <omp.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// State of a streamed solve. A chunk of up to rows equations is split into
+// up to parts sub-chunks, one per thread; sub-chunk s of chunk j is row
+// j * parts + s of the reduced system.
+typedef struct {
+  int in, out;
+  size_t n, rows, chunks;
+  int parts;
+} stream_t;
+
+static inline size_t chunk_rows(const stream_t *st, size_t j) {
+  const size_t lo = j * st->rows;
+  return st->n - lo < st->rows ? st->n - lo : st->rows;
+}
+
+static inline int chunk_parts(const stream_t *st, size_t m) {
+  return (size_t)st->parts < m ? st->parts : (int)m;
+}
+
+// First row of sub-chunk s when m rows are split into parts sub-chunks.
+static inline size_t part_begin(size_t m, int parts, int s) {
+  return m * (size_t)s / (size_t)parts;
+}
+
+static int read_full(int fd, void *buf, size_t bytes, off_t offset) {
+  char *p = (char *)buf;
+  while (bytes > 0) {
+    const ssize_t got = pread(fd, p, bytes, offset);
+    if (got <= 0) {
+      return -1; // Read error or unexpected end of file
+    }
+    p += got;
+    bytes -= (size_t)got;
+    offset += got;
+  }
+  return 0;
+}
+
+static int write_full(int fd, const void *buf, size_t bytes, off_t offset) {
+  const char *p = (const char *)buf;
+  while (bytes > 0) {
+    const ssize_t put = pwrite(fd, p, bytes, offset);
+    if (put <= 0) {
+      return -1; // Write error
+    }
+    p += put;
+    bytes -= (size_t)put;
+    offset += put;
+  }
+  return 0;
+}
+
+// Read a, b, c and d of chunk j into buf, each array taking st->rows floats.
+static int read_chunk(const stream_t *st, size_t j, float *buf) {
+  const size_t m = chunk_rows(st, j);
+  const off_t row = (off_t)(j * st->rows * sizeof(float));
+
+  for (int k = 0; k < 4; k++) {
+    if (read_full(st->in, buf + (size_t)k * st->rows, m * sizeof(float),
+                  triSLE_file_offset(st->n, sizeof(float), k) + row) != 0) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+static int write_chunk(const stream_t *st, size_t j, const float *x) {
+  const off_t row = (off_t)(j * st->rows * sizeof(float));
+  return write_full(st->out, x, chunk_rows(st, j) * sizeof(float),
+                    triSLE_file_offset(st->n, sizeof(float), 0) + row);
+}
+
+// Eliminate sub-chunk s of chunk j, whose coefficients are in buf.
+static void eliminate_part(const stream_t *st, size_t j, int s,
+                           const float *buf, float *coeffs, float *scratch,
+                           partition_chunk_t *summary) {
+  const size_t m = chunk_rows(st, j);
+  const int parts = chunk_parts(st, m);
+  const size_t lo = part_begin(m, parts, s);
+  const size_t hi = part_begin(m, parts, s + 1);
+  const float *a = buf;
+  const float *b = buf + st->rows;
+  const float *c = buf + 2 * st->rows;
+  const float *d = buf + 3 * st->rows;
+
+  partition_eliminate(a + lo, b + lo, c + lo, d + lo, hi - lo,
+                      j == 0 && s == 0,
+                      j + 1 == st->chunks && s + 1 == parts, coeffs + lo,
+                      coeffs + st->rows + lo, coeffs + 2 * st->rows + lo,
+                      scratch + lo, summary);
+}
+
+// Open the output container for writing and truncate it, unless it is the
+// input file itself, which would then be lost before it is read.
+static int open_output(const char *path, int in) {
+  const int fd = open(path, O_RDWR | O_CREAT, 0644);
+  if (fd < 0) {
+    return -1; // Failed to create the file
+  }
+
+  struct stat in_stat, out_stat;
+  const int refused = fstat(in, &in_stat) != 0 || fstat(fd, &out_stat) != 0 ||
+                      (in_stat.st_dev == out_stat.st_dev &&
+                       in_stat.st_ino == out_stat.st_ino);
+  if (refused || ftruncate(fd, 0) != 0) {
+    close(fd);
+    return -1; // Output is the input, or cannot be truncated
+  }
+
+  return fd;
+}
+
+int pcr_stream(const char *input, const char *output, size_t rows,
+               timer *start, timer *end) {
+  if (input == NULL || output == NULL || rows == 0) {
+    return -1; // Invalid parameter
+  }
+
+  // The output is only created, and an existing one only truncated, once
+  // the input is known to be a valid container.
+  stream_t st = {.in = open(input, O_RDONLY), .out = -1};
+  if (st.in < 0 ||
+      triSLE_file_check(st.in, sizeof(float), TRISLE_LAYOUT_PLANAR, &st.n) !=
+          0 ||
+      st.n == 0 || (st.out = open_output(output, st.in)) < 0 ||
+      triSLE_file_init(st.out, st.n, sizeof(float), TRISLE_LAYOUT_SOLUTION) !=
+          0) {
+    if (st.in >= 0) {
+      close(st.in);
+    }
+    if (st.out >= 0) {
+      close(st.out);
+    }
+    return -1; // Failed to open the containers
+  }
+
+  st.rows = rows < st.n ? rows : st.n;
+  st.chunks = (st.n + st.rows - 1) / st.rows;
+  st.parts = omp_get_max_threads();
+  if ((size_t)st.parts > st.rows) {
+    st.parts = (int)st.rows;
+  }
+
+  const size_t total =
+      (st.chunks - 1) * (size_t)st.parts +
+      (size_t)chunk_parts(&st, chunk_rows(&st, st.chunks - 1));
+
+  // Two chunks of coefficients and two of solution values are in flight, so
+  // that the transfer of one overlaps the computation of the other.
+  float *inbuf = (float *)malloc(8 * st.rows * sizeof(float));
+  float *xbuf = (float *)malloc(2 * st.rows * sizeof(float));
+  float *coeffs = (float *)malloc(3 * st.rows * sizeof(float));
+  partition_chunk_t *summaries =
+      (partition_chunk_t *)malloc(total * sizeof(partition_chunk_t));
+  triSLE_t *reduced = NULL;
+
+  int failed = inbuf == NULL || xbuf == NULL || coeffs == NULL ||
+               summaries == NULL || total > INT_MAX ||
+               triSLE_create(&reduced, (int)total) != 0;
+
+  if (!failed) {
+    TIME_GET(*start);
+
+    // Pass 1: summaries of all sub-chunks. While the threads eliminate
+    // chunk j, the first thread to finish reading chunk j + 1 joins them.
+    failed = read_chunk(&st, 0, inbuf);
+    for (size_t j = 0; j < st.chunks && !failed; j++) {
+      const float *cur = inbuf + (j % 2) * 4 * st.rows;
+      float *next = inbuf + ((j + 1) % 2) * 4 * st.rows;
+      const int parts = chunk_parts(&st, chunk_rows(&st, j));
+
+#pragma omp parallel
+      {
+#pragma omp single nowait
+        if (j + 1 < st.chunks) {
+          failed = read_chunk(&st, j + 1, next);
+        }
+
+#pragma omp for schedule(dynamic)
+        for (int s = 0; s < parts; s++) {
+          eliminate_part(&st, j, s, cur, coeffs, xbuf,
+                         &summaries[j * (size_t)st.parts + (size_t)s]);
+        }
+      }
+    }
+  }
+
+  if (!failed) {
+    timer reduced_start, reduced_end;
+    partition_reduce(summaries, total, reduced->a->data, reduced->b->data,
+                     reduced->c->data, reduced->d->data);
+    failed = pcr(reduced, &reduced_start, &reduced_end) != 0;
+  }
+
+  if (!failed) {
+    const float *X = reduced->x->data;
+
+    // Pass 2: the local coefficients take 3 n floats, so they are recomputed
+    // from the input instead of being spilled to disk and read back. Reading
+    // chunk j + 1 and writing the solution of chunk j - 1 overlap with
+    // chunk j.
+    failed = read_chunk(&st, 0, inbuf);
+    for (size_t j = 0; j < st.chunks && !failed; j++) {
+      const float *cur = inbuf + (j % 2) * 4 * st.rows;
+      float *next = inbuf + ((j + 1) % 2) * 4 * st.rows;
+      float *x = xbuf + (j % 2) * st.rows;
+      const float *x_prev = xbuf + ((j + 1) % 2) * st.rows;
+      const size_t m = chunk_rows(&st, j);
+      const int parts = chunk_parts(&st, m);
+
+#pragma omp parallel
+      {
+#pragma omp single nowait
+        {
+          int ret = 0;
+          if (j > 0) {
+            ret = write_chunk(&st, j - 1, x_prev);
+          }
+          if (ret == 0 && j + 1 < st.chunks) {
+            ret = read_chunk(&st, j + 1, next);
+          }
+          failed = ret != 0;
+        }
+
+        // x doubles as the scratch array of the elimination, as in pcr_mpi()
+#pragma omp for schedule(dynamic)
+        for (int s = 0; s < parts; s++) {
+          const size_t g = j * (size_t)st.parts + (size_t)s;
+          const size_t lo = part_begin(m, parts, s);
+          const size_t hi = part_begin(m, parts, s + 1);
+          partition_chunk_t summary;
+
+          eliminate_part(&st, j, s, cur, coeffs, x, &summary);
+          partition_substitute(coeffs + lo, coeffs + st.rows + lo,
+                               coeffs + 2 * st.rows + lo, hi - lo,
+                               g > 0 ? X[g - 1] : 0.0f, X[g], x + lo);
+        }
+      }
+    }
+
+    if (!failed) {
+      failed = write_chunk(&st, st.chunks - 1,
+                           xbuf + ((st.chunks - 1) % 2) * st.rows) != 0;
+    }
+
+    TIME_GET(*end);
+  }
+
+  if (reduced != NULL) {
+    triSLE_destroy(reduced);
+  }
+  free(summaries);
+  free(coeffs);
+  free(xbuf);
+  free(inbuf);
+  close(st.in);
+  if (close(st.out) != 0) {
+    failed = 1; // Failed to flush the solution
+  }
+
+  return failed ? -1 : 0;
+}
@@ -0,0 +1,87 @@
+#include "pcr_kernel.h"
+#include "pcr_simd.h"
+#include "sle.h"
+#include "solver.h"
+#include "util.h"
+#include "workspace.h"
+
+#include <omp.h>
+#include <stddef.h>
+
+// Number of neighbouring subsystems swept together by one thread. 16 floats
+// fill one 64 byte cache line, so every row of a group is a single line.
+#define THOMAS_GROUP 16
+
+static size_t auto_levels(size_t total_levels) {
+  const size_t min_subsystems = (size_t)omp_get_max_threads() * THOMAS_GROUP;
+
+  size_t levels = 0;
+  while (((size_t)1 << levels) < min_subsystems && levels < total_levels) {
+    levels++;
+  }
+  return levels;
+}
+
+int pcr_thomas(triSLE_t *sle, pcr_workspace_t *ws, int levels, timer *start,
+               timer *end) {
+  if (sle == NULL || ws == NULL) {
+    return -1;
+  }
+  size_t n = sle->b->n;
+  if (n == 0) {
+    return 0; // Nothing to do
+  }
+  if (n > ws->max_n) {
+    return -1; // Workspace too small
+  }
+
+  TIME_GET(*start);
+
+  const size_t total_levels = pcr_total_levels(n);
+  size_t pcr_levels = levels > 0 ? (size_t)levels : auto_levels(total_levels);
+  if (pcr_levels > total_levels) {
+    pcr_levels = total_levels;
+  }
+
+  float *sa = sle->a->data;
+  float *sb = sle->b->data;
+  float *sc = sle->c->data;
+  float *sd = sle->d->data;
+  float *ta = ws->tmp[0]->data;
+  float *tb = ws->tmp[1]->data;
+  float *tc = ws->tmp[2]->data;
+  float *td = ws->tmp[3]->data;
+  float *x = sle->x->data;
+
+  const pcr_update_range_fn kernel = pcr_update_range_select();
+
+  for (size_t level = 0; level < pcr_levels; level++) {
+    const int stride = 1 << level;
+    pcr_update_level(kernel, sa, sb, sc, sd, ta, tb, tc, td, (int)n, stride);
+
+    float *swap;
+    swap = sa, sa = ta, ta = swap;
+    swap = sb, sb = tb, tb = swap;
+    swap = sc, sc = tc, tc = swap;
+    swap = sd, sd = td, td = swap;
+  }
+
+  // After pcr_levels levels, row i is only coupled to i - stride and
+  // i + stride, i.e. the system has split into stride independent subsystems
+  // that are solved by sequential Thomas sweeps.
+  const int stride = 1 << pcr_levels;
+  const int subsystems = stride < (int)n ? stride : (int)n;
+  const int groups = (subsystems + THOMAS_GROUP - 1) / THOMAS_GROUP;
+
+#pragma omp parallel for schedule(static)
+  for (int g = 0; g < groups; g++) {
+    const int j0 = g * THOMAS_GROUP;
+    const int j1 = j0 + THOMAS_GROUP < subsystems ? j0 + THOMAS_GROUP
+                                                   : subsystems;
+    thomas_interleaved(sa, sb, sc, sd, x, (int)n, stride, j0, j1);
+  }
+
+  TIME_GET(*end);
+
+  return 0;
+}
@@ -0,0 +1,376 @@
+#include "pcr_tune.h"
+#include "pcr_kernel.h"
+#include "sle.h"
+#include "sle_arena.h"
+#include "sle_generate.h"
+#include "solver.h"
+#include "util.h"
+#include "workspace.h"
+
+#include <math.h>
+#include <omp.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Timed runs per candidate after the warmup
+#define PCR_TUNE_REPS 3
+
+// Seed of the calibration system
+#define PCR_TUNE_SEED 1234
+
+#define PCR_TUNE_MACHINE_MAX 256
+
+struct pcr_tuner_s {
+  char *path;
+  char machine[PCR_TUNE_MACHINE_MAX];
+  int max_threads;
+
+  int tuned[PCR_TUNE_CLASSES];
+  pcr_tune_entry_t table[PCR_TUNE_CLASSES];
+
+  pcr_workspace_t *ws; // for PCR and the hybrid solver
+  int ws_n;            // capacity of ws
+};
+
+// Indexed by pcr_tune_solver_e. Table lines of solvers missing here are
+// ignored.
+static const char *solver_names[] = {"thomas", "pcr", "hybrid",
+#if defined(PCR_TUNE_WITH_GPU)
+                                     "gpu"
+#endif
+};
+
+// PCR depths the hybrid solver is timed with, as far as n allows
+static const int hybrid_levels[] = {1, 2, 3, 4, 6, 8, 10, 12};
+
+static int size_class(int n) { return (int)pcr_total_levels((size_t)n); }
+
+static void machine_key(char *key, size_t size, int max_threads) {
+  char host[128];
+  if (gethostname(host, sizeof(host)) != 0) {
+    strcpy(host, "unknown");
+  }
+  host[sizeof(host) - 1] = '\0';
+#if defined(PCR_TUNE_WITH_GPU)
+  snprintf(key, size, "%s %d %s gpu", host, max_threads, pcr_kernel_name());
+#else
+  snprintf(key, size, "%s %d %s", host, max_threads, pcr_kernel_name());
+#endif
+}
+
+static int ensure_workspace(pcr_tuner_t *tuner, int n) {
+  if (tuner->ws != NULL && tuner->ws_n >= n) {
+    return 0;
+  }
+  if (tuner->ws != NULL) {
+    pcr_workspace_destroy(tuner->ws);
+    tuner->ws = NULL;
+  }
+  if (pcr_workspace_create(&tuner->ws, n) != 0) {
+    tuner->ws_n = 0;
+    return -1; // Memory allocation failed
+  }
+  tuner->ws_n = n;
+  return 0;
+}
+
+// Run the configuration of entry with its thread count, restoring the
+// caller's thread count afterwards
+static int run_entry(pcr_tuner_t *tuner, const pcr_tune_entry_t *entry,
+                     triSLE_t *sle, timer *start, timer *end) {
+  const int saved_threads = omp_get_max_threads();
+  int ret;
+
+  omp_set_num_threads(entry->threads);
+  switch (entry->solver) {
+  case PCR_TUNE_THOMAS:
+    ret = thomas(sle, start, end);
+    break;
+  case PCR_TUNE_PCR:
+    ret = pcr_ws(sle, tuner->ws, start, end);
+    break;
+  case PCR_TUNE_HYBRID:
+    ret = pcr_thomas(sle, tuner->ws, entry->levels, start, end);
+    break;
+#if defined(PCR_TUNE_WITH_GPU)
+  case PCR_TUNE_GPU:
+    ret = pcr_gpu(sle, start, end);
+    break;
+#endif
+  default:
+    ret = -1; // Unknown solver
+    break;
+  }
+  omp_set_num_threads(saved_threads);
+
+  return ret;
+}
+
+static int solution_is_finite(const triSLE_t *sle) {
+  const float *x = sle->x->data;
+  for (size_t i = 0; i < sle->x->n; i++) {
+    if (!isfinite(x[i])) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+// Fastest of PCR_TUNE_REPS runs after a warmup, or a negative value if the
+// candidate fails
+static double time_candidate(pcr_tuner_t *tuner, const pcr_tune_entry_t *entry,
+                             triSLE_t *reference, triSLE_t *work) {
+  double best = -1.0;
+
+  for (int rep = -1; rep < PCR_TUNE_REPS; rep++) {
+    timer start = {0, 0}, end = {0, 0};
+    triSLE_copy(work, reference);
+    if (run_entry(tuner, entry, work, &start, &end) != 0 ||
+        !solution_is_finite(work)) {
+      return -1.0;
+    }
+    const double seconds = TIME_DIFF(start, end);
+    if (rep >= 0 && (best < 0.0 || seconds < best)) {
+      best = seconds;
+    }
+  }
+
+  return best;
+}
+
+static void consider(pcr_tuner_t *tuner, const pcr_tune_entry_t *candidate,
+                     triSLE_t *reference, triSLE_t *work,
+                     pcr_tune_entry_t *best) {
+  const double seconds = time_candidate(tuner, candidate, reference, work);
+  if (seconds >= 0.0 && (best->seconds < 0.0 || seconds < best->seconds)) {
+    *best = *candidate;
+    best->seconds = seconds;
+  }
+}
+
+static int load_table(pcr_tuner_t *tuner) {
+  FILE *file = fopen(tuner->path, "r");
+  if (file == NULL) {
+    return -1; // No table yet
+  }
+
+  char line[PCR_TUNE_MACHINE_MAX + 16];
+  const size_t prefix = strlen("machine ");
+  int ret = -1;
+
+  // First non-comment line identifies the machine
+  while (fgets(line, sizeof(line), file) != NULL) {
+    if (line[0] == '#') {
+      continue;
+    }
+    line[strcspn(line, "\n")] = '\0';
+    if (strncmp(line, "machine ", prefix) == 0 &&
+        strcmp(line + prefix, tuner->machine) == 0) {
+      ret = 0;
+    }
+    break;
+  }
+
+  while (ret == 0 && fgets(line, sizeof(line), file) != NULL) {
+    int size, levels, threads;
+    char name[16];
+    double seconds;
+    if (line[0] == '#' ||
+        sscanf(line, "%d %15s %d %d %lf", &size, name, &levels, &threads,
+               &seconds) != 5 ||
+        size < 0 || size >= PCR_TUNE_CLASSES || threads < 1) {
+      continue;
+    }
+    for (int s = 0; s < (int)(sizeof(solver_names) / sizeof(*solver_names));
+         s++) {
+      if (strcmp(name, solver_names[s]) == 0) {
+        tuner->table[size].solver = s;
+        tuner->table[size].levels = levels;
+        tuner->table[size].threads = threads;
+        tuner->table[size].seconds = seconds;
+        tuner->tuned[size] = 1;
+      }
+    }
+  }
+
+  fclose(file);
+  return ret;
+}
+
+static int save_table(const pcr_tuner_t *tuner) {
+  FILE *file = fopen(tuner->path, "w");
+  if (file == NULL) {
+    return -1; // Failed to open the file
+  }
+
+  fprintf(file, "# pcr tuning table: log2(n) solver levels threads seconds\n");
+  fprintf(file, "machine %s\n", tuner->machine);
+  for (int size = 0; size < PCR_TUNE_CLASSES; size++) {
+    if (tuner->tuned[size]) {
+      const pcr_tune_entry_t *entry = &tuner->table[size];
+      fprintf(file, "%d %s %d %d %e\n", size, solver_names[entry->solver],
+              entry->levels, entry->threads, entry->seconds);
+    }
+  }
+
+  return fclose(file) == 0 ? 0 : -1;
+}
+
+int pcr_tuner_create(pcr_tuner_t **tuner, const char *path) {
+  if (tuner == NULL) {
+    return -1; // Invalid parameter
+  }
+
+  pcr_tuner_t *t = (pcr_tuner_t *)calloc(1, sizeof(pcr_tuner_t));
+  if (t == NULL) {
+    return -1; // Memory allocation failed
+  }
+
+  t->max_threads = omp_get_max_threads();
+  machine_key(t->machine, sizeof(t->machine), t->max_threads);
+
+  if (path != NULL) {
+    t->path = strdup(path);
+    if (t->path == NULL) {
+      free(t);
+      return -1; // Memory allocation failed
+    }
+    if (load_table(t) != 0) {
+      memset(t->tuned, 0, sizeof(t->tuned)); // Missing or foreign table
+    }
+  }
+
+  *tuner = t;
+  return 0; // Success
+}
+
+int pcr_tuner_destroy(pcr_tuner_t *tuner) {
+  if (tuner == NULL) {
+    return -1; // Invalid parameter
+  }
+
+  if (tuner->ws != NULL) {
+    pcr_workspace_destroy(tuner->ws);
+  }
+  free(tuner->path);
+  free(tuner);
+
+  return 0; // Success
+}
+
+int pcr_tuner_calibrate(pcr_tuner_t *tuner, int n) {
+  if (tuner == NULL || n < 1 || size_class(n) >= PCR_TUNE_CLASSES) {
+    return -1; // Invalid parameter
+  }
+  if (ensure_workspace(tuner, n) != 0) {
+    return -1; // Memory allocation failed
+  }
+
+  triSLE_t *reference = NULL, *work = NULL;
+  if (triSLE_arena_create(&reference, n, 0) != 0 ||
+      triSLE_arena_create(&work, n, 0) != 0 ||
+      triSLE_generate(reference, TRISLE_FAMILY_DOMINANT, PCR_TUNE_SEED) != 0) {
+    if (reference != NULL) {
+      triSLE_arena_destroy(reference);
+    }
+    if (work != NULL) {
+      triSLE_arena_destroy(work);
+    }
+    return -1; // Memory allocation failed
+  }
+
+  const int total_levels = size_class(n);
+  pcr_tune_entry_t best = {PCR_TUNE_THOMAS, 0, 1, -1.0};
+  pcr_tune_entry_t candidate = {PCR_TUNE_THOMAS, 0, 1, 0.0};
+  consider(tuner, &candidate, reference, work, &best);
+
+#if defined(PCR_TUNE_WITH_GPU)
+  candidate.solver = PCR_TUNE_GPU;
+  consider(tuner, &candidate, reference, work, &best);
+#endif
+
+  for (int threads = 1;; threads *= 2) {
+    if (threads > tuner->max_threads) {
+      threads = tuner->max_threads;
+    }
+
+    candidate.threads = threads;
+    candidate.solver = PCR_TUNE_PCR;
+    candidate.levels = 0;
+    consider(tuner, &candidate, reference, work, &best);
+
+    candidate.solver = PCR_TUNE_HYBRID;
+    for (size_t k = 0; k < sizeof(hybrid_levels) / sizeof(*hybrid_levels);
+         k++) {
+      if (hybrid_levels[k] >= total_levels) {
+        break; // Full depth is plain PCR
+      }
+      candidate.levels = hybrid_levels[k];
+      consider(tuner, &candidate, reference, work, &best);
+    }
+
+    if (threads == tuner->max_threads) {
+      break;
+    }
+  }
+
+  triSLE_arena_destroy(reference);
+  triSLE_arena_destroy(work);
+
+  if (best.seconds < 0.0) {
+    return -1; // No candidate solved the system
+  }
+
+  const int size = size_class(n);
+  tuner->table[size] = best;
+  tuner->tuned[size] = 1;
+
+  if (tuner->path != NULL && save_table(tuner) != 0) {
+    return -1; // Failed to write the table
+  }
+  return 0; // Success
+}
+
+int pcr_tuner_lookup(const pcr_tuner_t *tuner, int n, pcr_tune_entry_t *entry) {
+  if (tuner == NULL || entry == NULL || n < 1) {
+    return -1; // Invalid parameter
+  }
+
+  const int size = size_class(n);
+  if (size >= PCR_TUNE_CLASSES || !tuner->tuned[size]) {
+    return -1; // Size class not calibrated
+  }
+
+  *entry = tuner->table[size];
+  return 0; // Success
+}
+
+int pcr_tuned(pcr_tuner_t *tuner, triSLE_t *sle, timer *start, timer *end) {
+  if (tuner == NULL || sle == NULL) {
+    return -1; // Invalid parameter
+  }
+
+  const int n = (int)sle->b->n;
+  if (n == 0) {
+    return 0; // Nothing to do
+  }
+
+  pcr_tune_entry_t entry;
+  if (pcr_tuner_lookup(tuner, n, &entry) != 0) {
+    // A table that cannot be written is no reason to fail the solve
+    pcr_tuner_calibrate(tuner, n);
+    if (pcr_tuner_lookup(tuner, n, &entry) != 0) {
+      return -1; // Calibration failed
+    }
+  }
+
+  if ((entry.solver == PCR_TUNE_PCR || entry.solver == PCR_TUNE_HYBRID) &&
+      ensure_workspace(tuner, n) != 0) {
+    return -1; // Memory allocation failed
+  }
+
+  return run_entry(tuner, &entry, sle, start, end);
+}
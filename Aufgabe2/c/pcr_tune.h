@@ -0,0 +1,159 @@
+/**
+ * @file pcr_tune.h
+ * @brief Auto-tuned dispatch between the CPU solvers.
+ *
+ * Which solver is fastest depends on n and the machine: Thomas on one thread
+ * for small systems, the hybrid PCR-Thomas solver, plain PCR with many
+ * threads or the GPU for large ones. A tuner times every candidate once per
+ * size class
+ * (the powers of two ceil(log2(n))) and dispatches every later solve of that
+ * class to the fastest one, with its thread count and PCR depth.
+ *
+ * The table can be stored in a text file, one line per size class, which is
+ * only reused on the machine that wrote it (same host name, processor count
+ * and SIMD kernel) and by a build with the same candidates.
+ *
+ * The GPU is a candidate in builds with PCR_TUNE_WITH_GPU defined, which
+ * must link pcr_gpu.o (pcr_tune_gpu.o in the Makefile).
+ */
+
+#ifndef PCR_TUNE_H
+#define PCR_TUNE_H
+
+#include "sle.h"
+#include "util.h"
+
+/**
+ * @brief Number of size classes, i.e. n up to 2^(PCR_TUNE_CLASSES - 1).
+ */
+#define PCR_TUNE_CLASSES 32
+
+/**
+ * @enum pcr_tune_solver_e
+ * @brief Solvers the tuner chooses from.
+ */
+enum pcr_tune_solver_e {
+  PCR_TUNE_THOMAS = 0, /**< thomas(), always on one thread */
+  PCR_TUNE_PCR,        /**< pcr_ws() */
+  PCR_TUNE_HYBRID,     /**< pcr_thomas() */
+  PCR_TUNE_GPU,        /**< pcr_gpu(), only with PCR_TUNE_WITH_GPU */
+};
+
+/**
+ * @struct pcr_tune_entry_s
+ * @brief Fastest configuration of one size class.
+ *
+ * @var pcr_tune_entry_s::solver
+ *   One of pcr_tune_solver_e.
+ *
+ * @var pcr_tune_entry_s::levels
+ *   PCR levels of the hybrid solver, 0 otherwise.
+ *
+ * @var pcr_tune_entry_s::threads
+ *   Number of OpenMP threads.
+ *
+ * @var pcr_tune_entry_s::seconds
+ *   Measured solve time at calibration.
+ */
+struct pcr_tune_entry_s {
+  int solver;
+  int levels;
+  int threads;
+  double seconds;
+};
+
+/**
+ * @typedef pcr_tune_entry_t
+ * @brief Convenience typedef for struct pcr_tune_entry_s.
+ */
+typedef struct pcr_tune_entry_s pcr_tune_entry_t;
+
+/**
+ * @typedef pcr_tuner_t
+ * @brief Opaque tuning table with the scratch memory of the solvers.
+ */
+typedef struct pcr_tuner_s pcr_tuner_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Create a tuner, loading its table from a file if possible.
+ *
+ * A missing file, or one written on another machine, leaves the table
+ * empty.
+ *
+ * @param[out] tuner  Pointer to pcr_tuner_t pointer where the new tuner will
+ *                    be stored. Must not be NULL.
+ * @param[in]  path   File of the table, or NULL to keep it in memory only.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ *
+ * @note The caller is responsible for freeing the tuner using
+ *       pcr_tuner_destroy().
+ */
+int pcr_tuner_create(pcr_tuner_t **tuner, const char *path);
+
+/**
+ * @brief Destroy a tuner and free its resources.
+ *
+ * @param[in] tuner  Pointer to the tuner to destroy.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int pcr_tuner_destroy(pcr_tuner_t *tuner);
+
+/**
+ * @brief Time all candidates for the size class of n and store the fastest.
+ *
+ * Candidates are Thomas on one thread, pcr_gpu() in builds with
+ * PCR_TUNE_WITH_GPU, and PCR and the hybrid solver at several depths, each
+ * for 1, 2, 4, ... and omp_get_max_threads() threads, all on a diagonally
+ * dominant system of n equations. The GPU is timed including the transfers. Every candidate runs
+ * once to warm up and is then timed PCR_TUNE_REPS times; the minimum
+ * counts. The table is written to the file of the tuner afterwards.
+ *
+ * @param[in,out] tuner  The tuner.
+ * @param[in]     n      System size representing its class.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int pcr_tuner_calibrate(pcr_tuner_t *tuner, int n);
+
+/**
+ * @brief Look up the configuration for systems of n equations.
+ *
+ * @param[in]  tuner  The tuner.
+ * @param[in]  n      System size.
+ * @param[out] entry  Receives the configuration.
+ *
+ * @return 0 if the size class of n is calibrated, non-zero otherwise.
+ */
+int pcr_tuner_lookup(const pcr_tuner_t *tuner, int n, pcr_tune_entry_t *entry);
+
+/**
+ * @brief Solve a system with the fastest configuration for its size.
+ *
+ * Calibrates the size class first if it is not in the table yet, so the
+ * first solve of every class takes considerably longer.
+ *
+ * @param[in,out] tuner  The tuner.
+ * @param[in,out] sle    Pointer to the tridiagonal system to solve.
+ *                       On output, contains solution in sle->x.
+ * @param[out]    start  Timer to record the start time.
+ * @param[out]    end    Timer to record the end time.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ *
+ * @note The diagonals a, b, c and d are used as work space; their content is
+ *       unspecified after the call. A tuner must not be used by several
+ *       threads at once.
+ */
+int pcr_tuned(pcr_tuner_t *tuner, triSLE_t *sle, timer *start, timer *end);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PCR_TUNE_H
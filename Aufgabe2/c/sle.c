@@ -55,72 +55,59 @@ int triSLE_copy(triSLE_t *dest, triSLE_t *src) {
   return 0; // Success
 }
 
-float triSLE_validate_maxrel(triSLE_t *result_system,
-                             triSLE_t *initial_system) {
-  if (result_system == NULL || initial_system == NULL) {
-    return 0.0 / 0.0;
-  }
-
-  float result;
-  float max_relative_error = 0.0;
+#define REAL float
+#define TRISLE_T triSLE_t
+#define TRISLE_NAME(name) triSLE_##name
+#include "sle_validate_impl.h"
 
-  for (size_t i = 0; i < initial_system->b->n; i++) {
-    result = initial_system->b->data[i] * result_system->x->data[i];
+int triSLE_d_create(triSLE_d_t **soe, int n) {
+  triSLE_d_t *p = (triSLE_d_t *)calloc(1, sizeof(triSLE_d_t));
+  if (p == NULL) {
+    return -1; // Memory allocation failed
+  }
 
-    if (i > 0) {
-      result += initial_system->a->data[i] * result_system->x->data[i - 1];
-    }
+  if (diagonal_d_create(&p->a, n) != 0 || diagonal_d_create(&p->b, n) != 0 ||
+      diagonal_d_create(&p->c, n) != 0 || diagonal_d_create(&p->d, n) != 0 ||
+      diagonal_d_create(&p->x, n) != 0) {
+    triSLE_d_destroy(p);
+    return -1; // Memory allocation failed
+  }
 
-    if (i < initial_system->b->n - 1) {
-      result += initial_system->c->data[i] * result_system->x->data[i + 1];
-    }
+  *soe = p;
+  return 0; // Success
+}
 
-    // check for NaN
-    if (result != result) {
-      max_relative_error = result;
-      break;
-    }
+int triSLE_d_destroy(triSLE_d_t *soe) {
+  if (soe == NULL) {
+    return -1; // Invalid parameter
+  }
 
-    const float expected = initial_system->d->data[i];
-    if (expected != 0.0) {
-      float relative_error = fabs(result - expected) / (fabs(expected));
-      if (relative_error > max_relative_error) {
-        max_relative_error = relative_error;
-      }
+  diagonal_d_t *diagonals[] = {soe->a, soe->b, soe->c, soe->d, soe->x};
+  for (size_t k = 0; k < sizeof(diagonals) / sizeof(diagonals[0]); k++) {
+    if (diagonals[k] != NULL) {
+      diagonal_d_destroy(diagonals[k]);
     }
   }
 
-  return max_relative_error; // Success
+  FREE_IF_NOT_NULL(soe);
+
+  return 0; // Success
 }
 
-float triSLE_validate_mape(triSLE_t *result_system, triSLE_t *initial_system) {
-  if (result_system == NULL || initial_system == NULL) {
-    return 0.0 / 0.0;
+int triSLE_d_copy(triSLE_d_t *dest, triSLE_d_t *src) {
+  if (dest == NULL || src == NULL) {
+    return -1; // Invalid parameter
   }
 
-  float result;
-  float total_absolute_percentage_error = 0.0;
+  memcpy(dest->a->data, src->a->data, src->b->n * sizeof(double));
+  memcpy(dest->b->data, src->b->data, src->b->n * sizeof(double));
+  memcpy(dest->c->data, src->c->data, src->b->n * sizeof(double));
+  memcpy(dest->d->data, src->d->data, src->b->n * sizeof(double));
 
-  for (size_t i = 0; i < initial_system->b->n; i++) {
-    result = initial_system->b->data[i] * result_system->x->data[i];
-
-    if (i > 0) {
-      result += initial_system->a->data[i] * result_system->x->data[i - 1];
-    }
-
-    if (i < initial_system->b->n - 1) {
-      result += initial_system->c->data[i] * result_system->x->data[i + 1];
-    }
-
-    const float expected = initial_system->d->data[i];
-    if (expected != 0.0) {
-      float absolute_percentage_error =
-          fabs((result - expected) / expected) * 100.0;
-      total_absolute_percentage_error += absolute_percentage_error;
-    } else if (expected == 0.0 && result != 0.0) {
-      total_absolute_percentage_error += 1.0;
-    }
-  }
+  return 0; // Success
+}
 
-  return total_absolute_percentage_error / initial_system->b->n; // Success
-}
\ No newline at end of file
+#define REAL double
+#define TRISLE_T triSLE_d_t
+#define TRISLE_NAME(name) triSLE_d_##name
+#include "sle_validate_impl.h"
@@ -57,6 +57,56 @@ struct triSLE_s {
  */
 typedef struct triSLE_s triSLE_t;
 
+/**
+ * @struct triSLE_d_s
+ * @brief Double precision variant of triSLE_s.
+ *
+ * Has the same members as triSLE_s, each stored as diagonal_d_t.
+ */
+struct triSLE_d_s {
+  diagonal_d_t *a;
+  diagonal_d_t *b;
+  diagonal_d_t *c;
+  diagonal_d_t *d;
+
+  diagonal_d_t *x;
+};
+
+/**
+ * @typedef triSLE_d_t
+ * @brief Convenience typedef for struct triSLE_d_s.
+ */
+typedef struct triSLE_d_s triSLE_d_t;
+
+/**
+ * @struct triSLE_validation_s
+ * @brief Accuracy measures of a computed solution, see triSLE_validate().
+ *
+ * @var triSLE_validation_s::maxrel
+ *   Maximum relative error of the rows, NaN if A x contains NaN.
+ *
+ * @var triSLE_validation_s::mape
+ *   Mean absolute percentage error of the rows, in percent.
+ *
+ * @var triSLE_validation_s::residual_l2
+ *   Euclidean norm of the residual d - A x.
+ *
+ * @var triSLE_validation_s::residual_inf
+ *   Maximum norm of the residual d - A x.
+ */
+struct triSLE_validation_s {
+  double maxrel;
+  double mape;
+  double residual_l2;
+  double residual_inf;
+};
+
+/**
+ * @typedef triSLE_validation_t
+ * @brief Convenience typedef for struct triSLE_validation_s.
+ */
+typedef struct triSLE_validation_s triSLE_validation_t;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -110,6 +160,34 @@ int triSLE_destroy(triSLE_t *params);
  */
 int triSLE_copy(triSLE_t *dest, triSLE_t *src);
 
+/**
+ * @brief Compute all accuracy measures of a solution in one sweep.
+ *
+ * Forms A x once per row, with A and d taken from the reference system and
+ * x from the computed system, and derives the maximum relative error, the
+ * MAPE (see triSLE_validate_maxrel() and triSLE_validate_mape()) and the
+ * L2 and maximum norms of the residual from it. The sweep is parallelized
+ * with OpenMP and vectorized; the measures are accumulated in double
+ * precision.
+ *
+ * @param[in]  result      The system holding the computed solution x.
+ * @param[in]  before      The reference system with the original A and d.
+ * @param[out] validation  Receives the measures.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int triSLE_validate(triSLE_t *result, triSLE_t *before,
+                    triSLE_validation_t *validation);
+
+/**
+ * @brief Compute all accuracy measures of a solution of a periodic system.
+ *
+ * As triSLE_validate(), but a[0] couples the first row to x[n - 1] and
+ * c[n - 1] the last row to x[0] (see pcr_periodic()).
+ */
+int triSLE_validate_periodic(triSLE_t *result, triSLE_t *before,
+                             triSLE_validation_t *validation);
+
 /**
  * @brief Validate solution using maximum relative error.
  *
@@ -124,6 +202,7 @@ int triSLE_copy(triSLE_t *dest, triSLE_t *src);
  *         Returns 0.0 if before vector contains zero values.
  *
  * @note Useful for assessing solution accuracy when exact solutions are known.
+ *       Use triSLE_validate() to obtain several measures in one sweep.
  */
 float triSLE_validate_maxrel(triSLE_t *result, triSLE_t *before);
 
@@ -145,6 +224,80 @@ float triSLE_validate_maxrel(triSLE_t *result, triSLE_t *before);
  */
 float triSLE_validate_mape(triSLE_t *result, triSLE_t *before);
 
+/**
+ * @brief Compute the residual of a solution.
+ *
+ * Computes \f[ r = d - A x \f] with A and d taken from the reference system
+ * and x from the computed system.
+ *
+ * @param[in]  result    The system holding the computed solution x.
+ * @param[in]  before    The reference system with the original A and d.
+ * @param[out] residual  Array of n values receiving the residual.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int triSLE_residual(triSLE_t *result, triSLE_t *before, float *residual);
+
+/**
+ * @brief Create a new double precision tridiagonal system.
+ *
+ * @see triSLE_create()
+ */
+int triSLE_d_create(triSLE_d_t **params, int n);
+
+/**
+ * @brief Destroy a double precision tridiagonal system.
+ *
+ * @see triSLE_destroy()
+ */
+int triSLE_d_destroy(triSLE_d_t *params);
+
+/**
+ * @brief Copy one double precision tridiagonal system to another.
+ *
+ * @see triSLE_copy()
+ */
+int triSLE_d_copy(triSLE_d_t *dest, triSLE_d_t *src);
+
+/**
+ * @brief Compute all accuracy measures of a double precision solution in one
+ * sweep.
+ *
+ * @see triSLE_validate()
+ */
+int triSLE_d_validate(triSLE_d_t *result, triSLE_d_t *before,
+                      triSLE_validation_t *validation);
+
+/**
+ * @brief Compute all accuracy measures of a double precision periodic system.
+ *
+ * @see triSLE_validate_periodic()
+ */
+int triSLE_d_validate_periodic(triSLE_d_t *result, triSLE_d_t *before,
+                               triSLE_validation_t *validation);
+
+/**
+ * @brief Validate a double precision solution using maximum relative error.
+ *
+ * @see triSLE_validate_maxrel()
+ */
+double triSLE_d_validate_maxrel(triSLE_d_t *result, triSLE_d_t *before);
+
+/**
+ * @brief Validate a double precision solution using MAPE.
+ *
+ * @see triSLE_validate_mape()
+ */
+double triSLE_d_validate_mape(triSLE_d_t *result, triSLE_d_t *before);
+
+/**
+ * @brief Compute the residual of a double precision solution.
+ *
+ * @see triSLE_residual()
+ */
+int triSLE_d_residual(triSLE_d_t *result, triSLE_d_t *before,
+                      double *residual);
+
 #ifdef __cplusplus
 }
 #endif
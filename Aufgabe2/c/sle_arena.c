@@ -0,0 +1,183 @@
+#include "sle_arena.h"
+#include "diagonal.h"
+#include "sle.h"
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+// Alignment and granularity of huge page backed allocations
+#define TRISLE_HUGEPAGE_SIZE ((size_t)2 << 20)
+
+// Layout of an arena allocation. The system comes first, so that the
+// triSLE_t pointer handed out is the allocation itself.
+typedef struct arena_s {
+  triSLE_t sle;
+  diagonal_t diagonals[5];
+  size_t capacity;      // equations the arrays have room for
+  struct arena_s *next; // free list of a pool
+} arena_t;
+
+struct triSLE_pool_s {
+  int max_n;
+  int flags;
+
+  pthread_mutex_t lock;
+  arena_t *free_list; // guarded by lock
+};
+
+static size_t align_up(size_t bytes, size_t alignment) {
+  return (bytes + alignment - 1) / alignment * alignment;
+}
+
+static int arena_create(arena_t **arena, int capacity, int flags) {
+  if (arena == NULL || capacity < 0) {
+    return -1; // Invalid parameter
+  }
+
+  const size_t header = align_up(sizeof(arena_t), TRISLE_ARENA_ALIGN);
+  const size_t array =
+      align_up((capacity > 0 ? (size_t)capacity : 1) * sizeof(float),
+               TRISLE_ARENA_ALIGN);
+  size_t bytes = header + 5 * array;
+  size_t alignment = TRISLE_ARENA_ALIGN;
+
+  if (flags & TRISLE_ARENA_HUGEPAGES) {
+    alignment = TRISLE_HUGEPAGE_SIZE;
+    bytes = align_up(bytes, TRISLE_HUGEPAGE_SIZE);
+  }
+
+  void *base = NULL;
+  if (posix_memalign(&base, alignment, bytes) != 0) {
+    return -1; // Memory allocation failed
+  }
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  // Only a hint; takes effect at the first touch below
+  if (flags & TRISLE_ARENA_HUGEPAGES) {
+    madvise(base, bytes, MADV_HUGEPAGE);
+  }
+#endif
+
+  arena_t *p = (arena_t *)base;
+  p->capacity = (size_t)capacity;
+  p->next = NULL;
+
+  diagonal_t **members[5] = {&p->sle.a, &p->sle.b, &p->sle.c, &p->sle.d,
+                             &p->sle.x};
+  for (int k = 0; k < 5; k++) {
+    diagonal_t *diag = &p->diagonals[k];
+    diag->n = (size_t)capacity;
+    diag->data = (float *)((char *)base + header + (size_t)k * array);
+    diagonal_first_touch(diag->data, diag->n, sizeof(float));
+    *members[k] = diag;
+  }
+
+  *arena = p;
+  return 0; // Success
+}
+
+static void arena_resize(arena_t *arena, size_t n) {
+  for (int k = 0; k < 5; k++) {
+    arena->diagonals[k].n = n;
+  }
+}
+
+int triSLE_arena_create(triSLE_t **sle, int n, int flags) {
+  if (sle == NULL) {
+    return -1; // Invalid parameter
+  }
+
+  arena_t *arena;
+  if (arena_create(&arena, n, flags) != 0) {
+    return -1; // Memory allocation failed
+  }
+
+  *sle = &arena->sle;
+  return 0; // Success
+}
+
+int triSLE_arena_destroy(triSLE_t *sle) {
+  if (sle == NULL) {
+    return -1; // Invalid parameter
+  }
+
+  free(sle); // The system is the start of its allocation
+  return 0;  // Success
+}
+
+int triSLE_pool_create(triSLE_pool_t **pool, int max_n, int flags) {
+  if (pool == NULL || max_n < 0) {
+    return -1; // Invalid parameter
+  }
+
+  triSLE_pool_t *p = (triSLE_pool_t *)calloc(1, sizeof(triSLE_pool_t));
+  if (p == NULL) {
+    return -1; // Memory allocation failed
+  }
+
+  p->max_n = max_n;
+  p->flags = flags;
+  pthread_mutex_init(&p->lock, NULL);
+
+  *pool = p;
+  return 0; // Success
+}
+
+int triSLE_pool_acquire(triSLE_pool_t *pool, int n, triSLE_t **sle) {
+  if (pool == NULL || sle == NULL || n < 0 || n > pool->max_n) {
+    return -1; // Invalid parameter
+  }
+
+  pthread_mutex_lock(&pool->lock);
+  arena_t *arena = pool->free_list;
+  if (arena != NULL) {
+    pool->free_list = arena->next;
+  }
+  pthread_mutex_unlock(&pool->lock);
+
+  if (arena == NULL && arena_create(&arena, pool->max_n, pool->flags) != 0) {
+    return -1; // Memory allocation failed
+  }
+
+  arena_resize(arena, (size_t)n);
+  *sle = &arena->sle;
+  return 0; // Success
+}
+
+int triSLE_pool_release(triSLE_pool_t *pool, triSLE_t *sle) {
+  if (pool == NULL || sle == NULL) {
+    return -1; // Invalid parameter
+  }
+
+  arena_t *arena = (arena_t *)sle;
+  arena_resize(arena, arena->capacity);
+
+  pthread_mutex_lock(&pool->lock);
+  arena->next = pool->free_list;
+  pool->free_list = arena;
+  pthread_mutex_unlock(&pool->lock);
+
+  return 0; // Success
+}
+
+int triSLE_pool_destroy(triSLE_pool_t *pool) {
+  if (pool == NULL) {
+    return -1; // Invalid parameter
+  }
+
+  while (pool->free_list != NULL) {
+    arena_t *arena = pool->free_list;
+    pool->free_list = arena->next;
+    free(arena);
+  }
+
+  pthread_mutex_destroy(&pool->lock);
+  free(pool);
+
+  return 0; // Success
+}
@@ -0,0 +1,133 @@
+/**
+ * @file sle_arena.h
+ * @brief Single-allocation tridiagonal systems and a pool to recycle them.
+ *
+ * triSLE_create() allocates the structure, five diagonal_t and five arrays
+ * separately. An arena system places all of them in one allocation: the
+ * structures first, followed by the arrays a, b, c, d and x, each starting
+ * on a 64 byte boundary, so the SIMD kernels always see aligned data. The
+ * allocation can be backed by transparent huge pages, which cuts the number
+ * of page faults and TLB misses of large systems.
+ *
+ * A pool keeps released arena systems and hands them out again, so codes
+ * that create a system for every batch pay for the allocation and the page
+ * faults only once.
+ */
+
+#ifndef SLE_ARENA_H
+#define SLE_ARENA_H
+
+#include "sle.h"
+
+/**
+ * @brief Alignment of every array of an arena system in bytes.
+ */
+#define TRISLE_ARENA_ALIGN 64
+
+/**
+ * @enum triSLE_arena_flags_e
+ * @brief Options of arena systems.
+ *
+ * @var triSLE_arena_flags_e::TRISLE_ARENA_HUGEPAGES
+ *   Align the allocation to 2 MiB and request transparent huge pages from
+ *   the kernel (Linux only, ignored elsewhere).
+ */
+enum triSLE_arena_flags_e {
+  TRISLE_ARENA_HUGEPAGES = 1,
+};
+
+/**
+ * @typedef triSLE_pool_t
+ * @brief Opaque pool of arena systems.
+ */
+typedef struct triSLE_pool_s triSLE_pool_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Create a tridiagonal system in a single allocation.
+ *
+ * The arrays are zeroed with the static partition of the solvers, as in
+ * diagonal_create(). The system can be used wherever a system from
+ * triSLE_create() can.
+ *
+ * @param[out] sle    Pointer to triSLE_t pointer where the new system will
+ *                    be stored. Must not be NULL.
+ * @param[in]  n      Size of the system (number of equations).
+ * @param[in]  flags  Bitwise or of triSLE_arena_flags_e values, or 0.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ *
+ * @note The system must be freed with triSLE_arena_destroy(), not with
+ *       triSLE_destroy().
+ */
+int triSLE_arena_create(triSLE_t **sle, int n, int flags);
+
+/**
+ * @brief Free a system created by triSLE_arena_create().
+ *
+ * @param[in] sle  Pointer to the system to destroy.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int triSLE_arena_destroy(triSLE_t *sle);
+
+/**
+ * @brief Create a pool of arena systems of up to max_n equations.
+ *
+ * @param[out] pool   Pointer to triSLE_pool_t pointer where the new pool
+ *                    will be stored. Must not be NULL.
+ * @param[in]  max_n  Capacity of every system of the pool.
+ * @param[in]  flags  Flags of the systems, see triSLE_arena_create().
+ *
+ * @return 0 on success, non-zero error code on failure.
+ *
+ * @note The caller is responsible for freeing the pool using
+ *       triSLE_pool_destroy().
+ */
+int triSLE_pool_create(triSLE_pool_t **pool, int max_n, int flags);
+
+/**
+ * @brief Take a system of n <= max_n equations from the pool.
+ *
+ * Reuses a released system if there is one and creates a new one
+ * otherwise. The function is thread-safe.
+ *
+ * @param[in]  pool  The pool.
+ * @param[in]  n     Size of the system.
+ * @param[out] sle   Receives the system.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ *
+ * @note The content of a reused system is unspecified.
+ */
+int triSLE_pool_acquire(triSLE_pool_t *pool, int n, triSLE_t **sle);
+
+/**
+ * @brief Return a system to the pool.
+ *
+ * @param[in] pool  The pool the system was acquired from.
+ * @param[in] sle   The system. Must not be used afterwards.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int triSLE_pool_release(triSLE_pool_t *pool, triSLE_t *sle);
+
+/**
+ * @brief Free a pool and all systems released to it.
+ *
+ * @param[in] pool  Pointer to the pool to destroy.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ *
+ * @note Systems that are still acquired are not freed; release them before.
+ */
+int triSLE_pool_destroy(triSLE_pool_t *pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SLE_ARENA_H
@@ -0,0 +1,122 @@
+#include "sle_block.h"
+#include "diagonal.h"
+#include "util.h"
+
+#include <limits.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+int triSLE_block_create(triSLE_block_t **sle, int n, int m) {
+  if (sle == NULL || n < 0 || m < 1 || m > TRISLE_BLOCK_MAX ||
+      (size_t)n > (size_t)INT_MAX / ((size_t)m * m)) {
+    return -1; // Invalid parameter
+  }
+
+  triSLE_block_t *p = (triSLE_block_t *)calloc(1, sizeof(triSLE_block_t));
+  if (p == NULL) {
+    return -1; // Memory allocation failed
+  }
+
+  p->n = (size_t)n;
+  p->m = (size_t)m;
+
+  const int blocks = n * m * m;
+  if (diagonal_create(&p->a, blocks) != 0 ||
+      diagonal_create(&p->b, blocks) != 0 ||
+      diagonal_create(&p->c, blocks) != 0 ||
+      diagonal_create(&p->d, n * m) != 0 ||
+      diagonal_create(&p->x, n * m) != 0) {
+    triSLE_block_destroy(p);
+    return -1; // Memory allocation failed
+  }
+
+  *sle = p;
+  return 0; // Success
+}
+
+int triSLE_block_destroy(triSLE_block_t *sle) {
+  if (sle == NULL) {
+    return -1; // Invalid parameter
+  }
+
+  diagonal_t *diagonals[] = {sle->a, sle->b, sle->c, sle->d, sle->x};
+  for (int k = 0; k < 5; k++) {
+    if (diagonals[k] != NULL) {
+      diagonal_destroy(diagonals[k]);
+    }
+  }
+
+  FREE_IF_NOT_NULL(sle);
+
+  return 0; // Success
+}
+
+int triSLE_block_copy(triSLE_block_t *dest, triSLE_block_t *src) {
+  if (dest == NULL || src == NULL || dest->n != src->n || dest->m != src->m) {
+    return -1; // Invalid parameter
+  }
+
+  const size_t blocks = src->n * src->m * src->m;
+  memcpy(dest->a->data, src->a->data, blocks * sizeof(float));
+  memcpy(dest->b->data, src->b->data, blocks * sizeof(float));
+  memcpy(dest->c->data, src->c->data, blocks * sizeof(float));
+  memcpy(dest->d->data, src->d->data, src->n * src->m * sizeof(float));
+
+  return 0; // Success
+}
+
+int triSLE_block_validate(triSLE_block_t *result, triSLE_block_t *before,
+                          triSLE_validation_t *validation) {
+  if (result == NULL || before == NULL || validation == NULL ||
+      result->n != before->n || result->m != before->m) {
+    return -1; // Invalid parameter
+  }
+
+  const size_t n = before->n;
+  const size_t m = before->m;
+  const size_t mm = m * m;
+  const float *x = result->x->data;
+
+  double maxrel = 0.0, sum = 0.0, l2 = 0.0, inf = 0.0;
+  int nans = 0;
+
+#pragma omp parallel for schedule(static)                                      \
+    reduction(max : maxrel, inf) reduction(+ : sum, l2, nans)
+  for (size_t i = 0; i < n; i++) {
+    const float *a = before->a->data + i * mm;
+    const float *b = before->b->data + i * mm;
+    const float *c = before->c->data + i * mm;
+
+    for (size_t r = 0; r < m; r++) {
+      double product = 0.0;
+      for (size_t k = 0; k < m; k++) {
+        product += (double)b[r * m + k] * x[i * m + k];
+        if (i > 0) {
+          product += (double)a[r * m + k] * x[(i - 1) * m + k];
+        }
+        if (i + 1 < n) {
+          product += (double)c[r * m + k] * x[(i + 1) * m + k];
+        }
+      }
+
+      const double expected = before->d->data[i * m + r];
+      const double residual = fabs(expected - product);
+      const double relative = expected != 0.0 ? residual / fabs(expected) : 0.0;
+      maxrel = relative > maxrel ? relative : maxrel;
+      sum += expected != 0.0 ? relative * 100.0 : (product != 0.0 ? 1.0 : 0.0);
+      l2 += residual * residual;
+      inf = residual > inf ? residual : inf;
+      nans += product != product;
+    }
+  }
+
+  const size_t rows = n * m;
+  validation->maxrel = nans > 0 ? 0.0 / 0.0 : maxrel;
+  validation->mape = rows > 0 ? sum / (double)rows : 0.0;
+  validation->residual_l2 = sqrt(l2);
+  validation->residual_inf = inf;
+
+  return 0; // Success
+}
@@ -0,0 +1,128 @@
+/**
+ * @file sle_block.h
+ * @brief Block-tridiagonal systems of linear equations.
+ *
+ * Coupled PDEs lead to block-tridiagonal systems, where every coefficient is
+ * a small dense m x m matrix and every unknown a vector of m values. The
+ * blocks are stored row-major and one after the other, so block i of a
+ * diagonal starts at data + i * m * m and element (r, k) of it is at
+ * r * m + k. Vectors of block row i start at data + i * m.
+ */
+
+#ifndef SLE_BLOCK_H
+#define SLE_BLOCK_H
+
+#include "diagonal.h"
+#include "sle.h"
+
+#include <stddef.h>
+
+/**
+ * @brief Largest supported block size.
+ */
+#define TRISLE_BLOCK_MAX 8
+
+/**
+ * @struct triSLE_block_s
+ * @brief Represents a block-tridiagonal system of linear equations.
+ *
+ * @var triSLE_block_s::n
+ *   Number of block rows.
+ *
+ * @var triSLE_block_s::m
+ *   Block size, 1 <= m <= TRISLE_BLOCK_MAX.
+ *
+ * @var triSLE_block_s::a
+ *   Lower diagonal blocks (n * m * m values, first block unused).
+ *
+ * @var triSLE_block_s::b
+ *   Main diagonal blocks (n * m * m values).
+ *
+ * @var triSLE_block_s::c
+ *   Upper diagonal blocks (n * m * m values, last block unused).
+ *
+ * @var triSLE_block_s::d
+ *   Right-hand side (n * m values).
+ *
+ * @var triSLE_block_s::x
+ *   Solution vector (n * m values), stores the computed solution.
+ */
+struct triSLE_block_s {
+  size_t n;
+  size_t m;
+
+  diagonal_t *a;
+  diagonal_t *b;
+  diagonal_t *c;
+  diagonal_t *d;
+
+  diagonal_t *x;
+};
+
+/**
+ * @typedef triSLE_block_t
+ * @brief Convenience typedef for struct triSLE_block_s.
+ */
+typedef struct triSLE_block_s triSLE_block_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Create a new block-tridiagonal system.
+ *
+ * @param[out] sle  Pointer to triSLE_block_t pointer where the new system
+ *                  will be stored. Must not be NULL.
+ * @param[in]  n    Number of block rows.
+ * @param[in]  m    Block size, 1 <= m <= TRISLE_BLOCK_MAX.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ *
+ * @note The caller is responsible for freeing the allocated memory
+ *       using triSLE_block_destroy().
+ */
+int triSLE_block_create(triSLE_block_t **sle, int n, int m);
+
+/**
+ * @brief Destroy a block-tridiagonal system and free its resources.
+ *
+ * @param[in] sle  Pointer to the system to destroy.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ *
+ * @note After calling this function, the pointer becomes invalid
+ *       and should not be used.
+ */
+int triSLE_block_destroy(triSLE_block_t *sle);
+
+/**
+ * @brief Copy a, b, c and d of a block-tridiagonal system.
+ *
+ * @param[out] dest  Destination system of the same size.
+ * @param[in]  src   Source system.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int triSLE_block_copy(triSLE_block_t *dest, triSLE_block_t *src);
+
+/**
+ * @brief Compute the accuracy measures of a solution of a block system.
+ *
+ * As triSLE_validate(), with every one of the n * m scalar rows of the
+ * system taken as a row.
+ *
+ * @param[in]  result      The system holding the computed solution x.
+ * @param[in]  before      The reference system with the original A and d.
+ * @param[out] validation  Receives the measures.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int triSLE_block_validate(triSLE_block_t *result, triSLE_block_t *before,
+                          triSLE_validation_t *validation);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SLE_BLOCK_H
@@ -0,0 +1,163 @@
+#include "sle_generate.h"
+#include "pcr_kernel.h"
+#include "sle.h"
+
+#include <omp.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+static const char *const family_names[] = {"dominant", "poisson", "random",
+                                           "near-singular"};
+
+#define FAMILY_COUNT (sizeof(family_names) / sizeof(family_names[0]))
+
+// Philox4x32-10 (Salmon et al., SC'11): ten rounds of a keyed bijection of a
+// 128 bit counter.
+static inline void philox4x32(uint32_t ctr[4], uint64_t seed) {
+  uint32_t k0 = (uint32_t)seed;
+  uint32_t k1 = (uint32_t)(seed >> 32);
+
+  for (int round = 0; round < 10; round++) {
+    const uint64_t p0 = (uint64_t)0xD2511F53u * ctr[0];
+    const uint64_t p1 = (uint64_t)0xCD9E8D57u * ctr[2];
+    const uint32_t c1 = ctr[1];
+    const uint32_t c3 = ctr[3];
+
+    ctr[0] = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+    ctr[1] = (uint32_t)p1;
+    ctr[2] = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+    ctr[3] = (uint32_t)p0;
+
+    k0 += 0x9E3779B9u;
+    k1 += 0xBB67AE85u;
+  }
+}
+
+// Uniform in [0, 1) and in [-1, 1) from 32 random bits.
+static inline double uniform(uint32_t bits) { return bits * 0x1p-32; }
+static inline double uniform_signed(uint32_t bits) {
+  return (int32_t)bits * 0x1p-31;
+}
+
+// a, b, c and d of row i of an n x n matrix of the family.
+static inline void family_row(triSLE_family_t family, uint64_t seed,
+                              size_t i, size_t n, double row[4]) {
+  uint32_t r[4] = {(uint32_t)i, (uint32_t)((uint64_t)i >> 32), 0, 0};
+  philox4x32(r, seed);
+
+  double a, b, c;
+  switch (family) {
+  case TRISLE_FAMILY_POISSON:
+    a = -1.0;
+    b = 2.0;
+    c = -1.0;
+    break;
+  case TRISLE_FAMILY_RANDOM:
+    a = uniform_signed(r[0]) * 1e-5;
+    b = uniform_signed(r[1]) * 1e2;
+    c = uniform_signed(r[2]) * 1e-5;
+    break;
+  case TRISLE_FAMILY_NEAR_SINGULAR:
+  case TRISLE_FAMILY_DOMINANT:
+  default:
+    a = uniform_signed(r[0]);
+    c = uniform_signed(r[2]);
+    b = (a < 0 ? -a : a) + (c < 0 ? -c : c);
+    b += family == TRISLE_FAMILY_DOMINANT ? 1.0 + uniform(r[1])
+                                          : 1e-6 * (1.0 + uniform(r[1]));
+    break;
+  }
+
+  row[0] = i > 0 ? a : 0.0;
+  row[1] = b;
+  row[2] = i + 1 < n ? c : 0.0;
+  row[3] = uniform_signed(r[3]);
+}
+
+int triSLE_generate(triSLE_t *sle, triSLE_family_t family, uint64_t seed) {
+  if (sle == NULL) {
+    return -1; // Invalid parameter
+  }
+
+  return triSLE_generate_block(sle, family, seed, 0, sle->b->n);
+}
+
+int triSLE_generate_block(triSLE_t *sle, triSLE_family_t family,
+                          uint64_t seed, size_t first, size_t n) {
+  if (sle == NULL || (size_t)family >= FAMILY_COUNT ||
+      first + sle->b->n > n) {
+    return -1; // Invalid parameter
+  }
+
+  const size_t m = sle->b->n;
+  float *a = sle->a->data;
+  float *b = sle->b->data;
+  float *c = sle->c->data;
+  float *d = sle->d->data;
+
+#pragma omp parallel
+  {
+    int lo, hi;
+    pcr_thread_range((int)m, omp_get_thread_num(), omp_get_num_threads(), &lo,
+                     &hi);
+    for (int i = lo; i < hi; i++) {
+      double row[4];
+      family_row(family, seed, first + (size_t)i, n, row);
+      a[i] = (float)row[0];
+      b[i] = (float)row[1];
+      c[i] = (float)row[2];
+      d[i] = (float)row[3];
+    }
+  }
+
+  return 0; // Success
+}
+
+int triSLE_d_generate(triSLE_d_t *sle, triSLE_family_t family, uint64_t seed) {
+  if (sle == NULL || (size_t)family >= FAMILY_COUNT) {
+    return -1; // Invalid parameter
+  }
+
+  const size_t n = sle->b->n;
+  double *a = sle->a->data;
+  double *b = sle->b->data;
+  double *c = sle->c->data;
+  double *d = sle->d->data;
+
+#pragma omp parallel
+  {
+    int lo, hi;
+    pcr_thread_range((int)n, omp_get_thread_num(), omp_get_num_threads(), &lo,
+                     &hi);
+    for (int i = lo; i < hi; i++) {
+      double row[4];
+      family_row(family, seed, (size_t)i, n, row);
+      a[i] = row[0];
+      b[i] = row[1];
+      c[i] = row[2];
+      d[i] = row[3];
+    }
+  }
+
+  return 0; // Success
+}
+
+int triSLE_family_from_name(const char *name, triSLE_family_t *family) {
+  if (name == NULL || family == NULL) {
+    return -1; // Invalid parameter
+  }
+
+  for (size_t k = 0; k < FAMILY_COUNT; k++) {
+    if (strcmp(name, family_names[k]) == 0) {
+      *family = (triSLE_family_t)k;
+      return 0; // Success
+    }
+  }
+
+  return -1; // Unknown family
+}
+
+const char *triSLE_family_name(triSLE_family_t family) {
+  return (size_t)family < FAMILY_COUNT ? family_names[family] : NULL;
+}
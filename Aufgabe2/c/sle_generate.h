@@ -0,0 +1,117 @@
+/**
+ * @file sle_generate.h
+ * @brief Reproducible parallel generation of test systems.
+ *
+ * Every row is generated from the Philox4x32-10 counter-based random number
+ * generator with the row index as counter and the seed as key. A row does not
+ * depend on any other row, so the rows are filled in parallel with the static
+ * partition of the solvers (which also places their pages on the NUMA node
+ * of the working thread), and the system is the same for any number of
+ * threads.
+ */
+
+#ifndef SLE_GENERATE_H
+#define SLE_GENERATE_H
+
+#include "sle.h"
+
+#include <stdint.h>
+
+/**
+ * @enum triSLE_family_e
+ * @brief Named families of test matrices.
+ *
+ * The right-hand side is uniform in [-1, 1) for all families.
+ */
+enum triSLE_family_e {
+  /** a and c uniform in [-1, 1), b uniform in [|a| + |c| + 1, |a| + |c| + 2),
+   *  i.e. strictly diagonally dominant. */
+  TRISLE_FAMILY_DOMINANT = 0,
+  /** The 1D Poisson matrix tridiag(-1, 2, -1), condition number O(n^2). */
+  TRISLE_FAMILY_POISSON,
+  /** Random signs, |a|, |c| < 1e-5 and |b| < 1e2, the distribution used by
+   *  the example programs. Not necessarily well conditioned. */
+  TRISLE_FAMILY_RANDOM,
+  /** As TRISLE_FAMILY_DOMINANT, but b exceeds |a| + |c| by less than 2e-6,
+   *  so the matrix is close to singular. */
+  TRISLE_FAMILY_NEAR_SINGULAR,
+};
+
+/**
+ * @typedef triSLE_family_t
+ * @brief Convenience typedef for enum triSLE_family_e.
+ */
+typedef enum triSLE_family_e triSLE_family_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Fill a system with a matrix of the given family.
+ *
+ * Sets a, b, c and d of all rows. a[0] and c[n - 1] are set to zero.
+ *
+ * @param[in,out] sle     The system to fill.
+ * @param[in]     family  Matrix family.
+ * @param[in]     seed    Seed of the generator. The same seed yields the
+ *                        same system, independently of the thread count.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int triSLE_generate(triSLE_t *sle, triSLE_family_t family, uint64_t seed);
+
+/**
+ * @brief Fill a system with a block of consecutive rows of a larger matrix.
+ *
+ * Row i of sle receives row first + i of the n x n matrix that
+ * triSLE_generate() would create with the same family and seed, e.g. for the
+ * blocks of a system distributed over MPI ranks.
+ *
+ * @param[in,out] sle     The system to fill, with first + sle->b->n <= n.
+ * @param[in]     family  Matrix family.
+ * @param[in]     seed    Seed of the generator.
+ * @param[in]     first   Global index of the first row of the block.
+ * @param[in]     n       Number of rows of the whole matrix.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int triSLE_generate_block(triSLE_t *sle, triSLE_family_t family,
+                          uint64_t seed, size_t first, size_t n);
+
+/**
+ * @brief Fill a double precision system with a matrix of the given family.
+ *
+ * Rows are the double precision counterparts of the rows generated by
+ * triSLE_generate() with the same seed.
+ *
+ * @see triSLE_generate()
+ */
+int triSLE_d_generate(triSLE_d_t *sle, triSLE_family_t family, uint64_t seed);
+
+/**
+ * @brief Look up a family by name.
+ *
+ * @param[in]  name    One of "dominant", "poisson", "random" and
+ *                     "near-singular".
+ * @param[out] family  Receives the family.
+ *
+ * @return 0 on success, non-zero if the name is unknown.
+ */
+int triSLE_family_from_name(const char *name, triSLE_family_t *family);
+
+/**
+ * @brief Name of a family.
+ *
+ * @param[in] family  Matrix family.
+ *
+ * @return Name as accepted by triSLE_family_from_name(), or NULL for an
+ *         invalid family.
+ */
+const char *triSLE_family_name(triSLE_family_t family);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SLE_GENERATE_H
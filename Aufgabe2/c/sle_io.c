@@ -0,0 +1,214 @@
+#include "sle_io.h"
+#include "diagonal.h"
+#include "sle.h"
+#include "util.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+_Static_assert(sizeof(triSLE_file_header_t) == TRISLE_FILE_HEADER_SIZE,
+               "triSLE_file_header_t must match TRISLE_FILE_HEADER_SIZE");
+
+// Bytes of one array of n elements, padded to the alignment.
+static size_t array_bytes(size_t n, size_t size) {
+  return (n * size + TRISLE_FILE_ALIGN - 1) / TRISLE_FILE_ALIGN *
+         TRISLE_FILE_ALIGN;
+}
+
+// Bytes of a container with the given layout.
+static size_t container_bytes(size_t n, size_t size, uint32_t layout) {
+  const size_t arrays = layout == TRISLE_LAYOUT_PLANAR ? 4 : 1;
+  return TRISLE_FILE_HEADER_SIZE + arrays * array_bytes(n, size);
+}
+
+static void header_init(triSLE_file_header_t *header, size_t n, size_t size,
+                        uint32_t layout) {
+  memset(header, 0, sizeof(*header));
+  memcpy(header->magic, TRISLE_FILE_MAGIC, sizeof(header->magic));
+  header->version = TRISLE_FILE_VERSION;
+  header->precision = (uint32_t)size;
+  header->layout = layout;
+  header->n = n;
+}
+
+off_t triSLE_file_offset(size_t n, size_t precision, int k) {
+  return (off_t)(TRISLE_FILE_HEADER_SIZE +
+                 (size_t)k * array_bytes(n, precision));
+}
+
+int triSLE_file_check(int fd, size_t precision, uint32_t layout, size_t *n) {
+  if (n == NULL) {
+    return -1; // Invalid parameter
+  }
+
+  struct stat st;
+  triSLE_file_header_t header;
+  if (fstat(fd, &st) != 0 ||
+      pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header)) {
+    return -1; // Not a container
+  }
+
+  if (memcmp(header.magic, TRISLE_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+      header.version != TRISLE_FILE_VERSION ||
+      header.precision != precision || header.layout != layout ||
+      container_bytes(header.n, precision, layout) != (size_t)st.st_size) {
+    return -1; // Invalid header or truncated file
+  }
+
+  *n = (size_t)header.n;
+  return 0; // Success
+}
+
+int triSLE_file_init(int fd, size_t n, size_t precision, uint32_t layout) {
+  triSLE_file_header_t header;
+  header_init(&header, n, precision, layout);
+
+  if (ftruncate(fd, (off_t)container_bytes(n, precision, layout)) != 0 ||
+      pwrite(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header)) {
+    return -1; // Failed to write the header
+  }
+
+  return 0; // Success
+}
+
+// Write the four arrays of a system in the planar layout.
+static int write_planar(const char *path, const void *const arrays[4],
+                        size_t n, size_t size) {
+  if (path == NULL) {
+    return -1; // Invalid parameter
+  }
+
+  FILE *file = fopen(path, "wb");
+  if (file == NULL) {
+    return -1; // Failed to create the file
+  }
+
+  static const char zeros[TRISLE_FILE_ALIGN];
+  const size_t padding = array_bytes(n, size) - n * size;
+  triSLE_file_header_t header;
+  header_init(&header, n, size, TRISLE_LAYOUT_PLANAR);
+
+  int ret = fwrite(&header, sizeof(header), 1, file) == 1 ? 0 : -1;
+  for (size_t k = 0; k < 4 && ret == 0; k++) {
+    if (fwrite(arrays[k], size, n, file) != n ||
+        fwrite(zeros, 1, padding, file) != padding) {
+      ret = -1; // Failed to write the arrays
+    }
+  }
+
+  if (fclose(file) != 0) {
+    ret = -1; // Failed to flush the file
+  }
+  return ret;
+}
+
+// Map an existing container privately and return its base, or NULL if the
+// file is not a valid container of the given precision and layout. If n is
+// not zero, the container must have n elements.
+static char *map_existing(const char *path, size_t size, uint32_t layout,
+                          size_t *n) {
+  if (path == NULL) {
+    return NULL; // Invalid parameter
+  }
+
+  const int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return NULL; // Failed to open the file
+  }
+
+  size_t count = 0;
+  // Systems in memory are indexed with int
+  if (triSLE_file_check(fd, size, layout, &count) != 0 || count > INT_MAX ||
+      (*n != 0 && count != *n)) {
+    close(fd);
+    return NULL; // Not a matching container
+  }
+
+  // Writable so that solvers can use the diagonals as work space; written
+  // pages are copied on write and never reach the file.
+  char *base = (char *)mmap(NULL, container_bytes(count, size, layout),
+                            PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    return NULL; // Failed to map the file
+  }
+
+  *n = count;
+  return base;
+}
+
+// Map a new solution container of n elements, shared with the file at path
+// or anonymous if path is NULL, and return its base or NULL on failure. An
+// existing file is only truncated once it is known not to be the input.
+static char *map_output(const char *path, const char *input, size_t n,
+                        size_t size) {
+  const size_t bytes = container_bytes(n, size, TRISLE_LAYOUT_SOLUTION);
+  char *base;
+
+  if (path == NULL) {
+    base = (char *)mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base != MAP_FAILED) {
+      header_init((triSLE_file_header_t *)base, n, size,
+                  TRISLE_LAYOUT_SOLUTION);
+    }
+  } else {
+    const int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+      return NULL; // Failed to create the file
+    }
+
+    struct stat in_stat, out_stat;
+    const int refused = stat(input, &in_stat) != 0 ||
+                        fstat(fd, &out_stat) != 0 ||
+                        (in_stat.st_dev == out_stat.st_dev &&
+                         in_stat.st_ino == out_stat.st_ino);
+    if (refused || ftruncate(fd, 0) != 0 ||
+        triSLE_file_init(fd, n, size, TRISLE_LAYOUT_SOLUTION) != 0) {
+      close(fd);
+      return NULL; // Output is the input, or cannot be sized
+    }
+    base = (char *)mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+  }
+
+  return base == MAP_FAILED ? NULL : base;
+}
+
+// Unmap the containers whose arrays start at a (planar) and x (solution).
+static int unmap_containers(void *a, void *x, size_t n, size_t size) {
+  int ret = 0;
+
+  if (a != NULL &&
+      munmap((char *)a - TRISLE_FILE_HEADER_SIZE,
+             container_bytes(n, size, TRISLE_LAYOUT_PLANAR)) != 0) {
+    ret = -1;
+  }
+  if (x != NULL &&
+      munmap((char *)x - TRISLE_FILE_HEADER_SIZE,
+             container_bytes(n, size, TRISLE_LAYOUT_SOLUTION)) != 0) {
+    ret = -1;
+  }
+
+  return ret;
+}
+
+#define REAL float
+#define TRISLE_T triSLE_t
+#define DIAGONAL_T diagonal_t
+#define TRISLE_NAME(name) triSLE_##name
+#include "sle_io_impl.h"
+
+#define REAL double
+#define TRISLE_T triSLE_d_t
+#define DIAGONAL_T diagonal_d_t
+#define TRISLE_NAME(name) triSLE_d_##name
+#include "sle_io_impl.h"
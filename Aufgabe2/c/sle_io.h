@@ -0,0 +1,240 @@
+/**
+ * @file sle_io.h
+ * @brief Binary container for tridiagonal systems, backed by mmap.
+ *
+ * A container starts with a TRISLE_FILE_HEADER_SIZE byte header followed by
+ * the arrays of the system, each padded to TRISLE_FILE_ALIGN bytes:
+ *
+ * \code
+ * system:   header | a[0 .. n-1] | b[0 .. n-1] | c[0 .. n-1] | d[0 .. n-1]
+ * solution: header | x[0 .. n-1]
+ * \endcode
+ *
+ * All values are stored in the byte order of the machine that wrote the
+ * file. Mapping a container makes the diagonals of a system point into the
+ * page cache, so loading or storing a system never copies or parses the
+ * arrays.
+ */
+
+#ifndef SLE_IO_H
+#define SLE_IO_H
+
+#include "sle.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/**
+ * @brief First eight bytes of every container.
+ */
+#define TRISLE_FILE_MAGIC "TRISLE\r\n"
+
+/**
+ * @brief Container format version written by this implementation.
+ */
+#define TRISLE_FILE_VERSION 1
+
+/**
+ * @brief Size of the header in bytes, which is also the offset of array a.
+ */
+#define TRISLE_FILE_HEADER_SIZE 64
+
+/**
+ * @brief Alignment of every array within the container in bytes.
+ */
+#define TRISLE_FILE_ALIGN 64
+
+/**
+ * @enum triSLE_layout_e
+ * @brief Arrays stored in a container.
+ */
+enum triSLE_layout_e {
+  TRISLE_LAYOUT_PLANAR = 0,   ///< The system: a, b, c and d one after another
+  TRISLE_LAYOUT_SOLUTION = 1, ///< The solution x of a system
+};
+
+/**
+ * @struct triSLE_file_header_s
+ * @brief Header of a container.
+ *
+ * @var triSLE_file_header_s::magic
+ *   TRISLE_FILE_MAGIC, without a terminating null character.
+ *
+ * @var triSLE_file_header_s::version
+ *   TRISLE_FILE_VERSION. A file of different byte order fails this check.
+ *
+ * @var triSLE_file_header_s::precision
+ *   Size of one element in bytes (4 for float, 8 for double).
+ *
+ * @var triSLE_file_header_s::layout
+ *   One of triSLE_layout_e.
+ *
+ * @var triSLE_file_header_s::n
+ *   Number of equations.
+ */
+struct triSLE_file_header_s {
+  char magic[8];
+  uint32_t version;
+  uint32_t precision;
+  uint32_t layout;
+  uint32_t reserved;
+  uint64_t n;
+  uint8_t padding[TRISLE_FILE_HEADER_SIZE - 32];
+};
+
+/**
+ * @typedef triSLE_file_header_t
+ * @brief Convenience typedef for struct triSLE_file_header_s.
+ */
+typedef struct triSLE_file_header_s triSLE_file_header_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Check the header of an open container.
+ *
+ * @param[in]  fd         File descriptor of the container.
+ * @param[in]  precision  Expected size of one element in bytes.
+ * @param[in]  layout     Expected layout (one of triSLE_layout_e).
+ * @param[out] n          Number of equations of the container.
+ *
+ * @return 0 if the header matches and the file has the size implied by it,
+ *         non-zero otherwise.
+ */
+int triSLE_file_check(int fd, size_t precision, uint32_t layout, size_t *n);
+
+/**
+ * @brief Write the header of a new container and size the file.
+ *
+ * The arrays read as zero until they are written, e.g. with pwrite() at
+ * triSLE_file_offset().
+ *
+ * @param[in] fd         File descriptor of the container, open for writing.
+ * @param[in] n          Number of equations.
+ * @param[in] precision  Size of one element in bytes.
+ * @param[in] layout     Layout of the container (one of triSLE_layout_e).
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int triSLE_file_init(int fd, size_t n, size_t precision, uint32_t layout);
+
+/**
+ * @brief Byte offset of array k of a container.
+ *
+ * @param[in] n          Number of equations.
+ * @param[in] precision  Size of one element in bytes.
+ * @param[in] k          Index of the array (0 = a, 1 = b, 2 = c, 3 = d for a
+ *                       system, 0 = x for a solution).
+ *
+ * @return Offset of element 0 of the array from the start of the file.
+ */
+off_t triSLE_file_offset(size_t n, size_t precision, int k);
+
+/**
+ * @brief Write the coefficients and right-hand side of a system to a
+ * container.
+ *
+ * @param[in] sle   The system to store (a, b, c and d).
+ * @param[in] path  Path of the file, which is created or truncated.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int triSLE_write(triSLE_t *sle, const char *path);
+
+/**
+ * @brief Create a system backed by a mapping of a container.
+ *
+ * The input is mapped privately: a, b, c and d point into the page cache,
+ * and solvers that use them as work space only modify private copies of the
+ * pages they write, never the file. If output is not NULL, x points into a
+ * shared mapping of a new solution container, so the solution is written to
+ * the file without a copy. Otherwise x is anonymous memory.
+ *
+ * Mapping the same input twice yields two independent systems sharing the
+ * unmodified pages, e.g. a reference copy for validation.
+ *
+ * @param[out] sle     Pointer to triSLE_t pointer where the new system will
+ *                     be stored. Must not be NULL.
+ * @param[in]  input   Path of a single precision system container.
+ * @param[in]  output  Path of the solution container to create, or NULL.
+ *                     An existing file is truncated only once the input is
+ *                     valid, and never if it is the input itself.
+ *
+ * @return 0 on success, non-zero error code on failure (e.g., a missing
+ *         file, a wrong magic, version, precision or layout, a file size
+ *         that does not match the header, or output naming the input).
+ *
+ * @note The caller is responsible for releasing the system using
+ *       triSLE_unmap(), not triSLE_destroy().
+ */
+int triSLE_map(triSLE_t **sle, const char *input, const char *output);
+
+/**
+ * @brief Create a system backed by mappings of a container and of an
+ * existing solution container, e.g. to validate a solution written before.
+ *
+ * @param[out] sle       Pointer to triSLE_t pointer where the new system
+ *                       will be stored. Must not be NULL.
+ * @param[in]  input     Path of a single precision system container.
+ * @param[in]  solution  Path of a solution container of the same size.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ *
+ * @note Both files are mapped privately and never modified. The caller is
+ *       responsible for releasing the system using triSLE_unmap().
+ */
+int triSLE_map_solved(triSLE_t **sle, const char *input,
+                      const char *solution);
+
+/**
+ * @brief Unmap a system created with triSLE_map() or triSLE_map_solved().
+ *
+ * The solution is written back to the output file by the kernel; the data
+ * is durable once the pages have been flushed.
+ *
+ * @param[in] sle  Pointer to the system to release.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int triSLE_unmap(triSLE_t *sle);
+
+/**
+ * @brief Write a double precision system to a container.
+ *
+ * @see triSLE_write()
+ */
+int triSLE_d_write(triSLE_d_t *sle, const char *path);
+
+/**
+ * @brief Create a double precision system backed by a mapping of a
+ * container.
+ *
+ * @see triSLE_map()
+ */
+int triSLE_d_map(triSLE_d_t **sle, const char *input, const char *output);
+
+/**
+ * @brief Create a double precision system backed by mappings of a container
+ * and of an existing solution container.
+ *
+ * @see triSLE_map_solved()
+ */
+int triSLE_d_map_solved(triSLE_d_t **sle, const char *input,
+                        const char *solution);
+
+/**
+ * @brief Unmap a system created with triSLE_d_map() or
+ * triSLE_d_map_solved().
+ *
+ * @see triSLE_unmap()
+ */
+int triSLE_d_unmap(triSLE_d_t *sle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SLE_IO_H
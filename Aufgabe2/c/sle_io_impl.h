@@ -0,0 +1,107 @@
+/**
+ * @file sle_io_impl.h
+ * @brief Precision-generic container routines for tridiagonal systems.
+ *
+ * This file is a template that sle_io.c includes once per precision. Before
+ * inclusion the following macros must be defined:
+ * - REAL:              element type (float or double)
+ * - TRISLE_T:          system type (triSLE_t or triSLE_d_t)
+ * - DIAGONAL_T:        diagonal type (diagonal_t or diagonal_d_t)
+ * - TRISLE_NAME(name): public function name for the precision
+ *
+ * The macros are undefined again at the end of the file.
+ */
+
+int TRISLE_NAME(write)(TRISLE_T *sle, const char *path) {
+  if (sle == NULL) {
+    return -1; // Invalid parameter
+  }
+
+  const void *const arrays[4] = {sle->a->data, sle->b->data, sle->c->data,
+                                 sle->d->data};
+  return write_planar(path, arrays, sle->b->n, sizeof(REAL));
+}
+
+// Create a system on the mapped containers in (planar) and out (solution)
+// of n elements. Both mappings are released on failure.
+static int TRISLE_NAME(map_containers)(TRISLE_T **sle, char *in, char *out,
+                                       size_t n) {
+  TRISLE_T *p = (TRISLE_T *)calloc(1, sizeof(TRISLE_T));
+  // The five diagonals share one allocation, released through p->a.
+  DIAGONAL_T *diagonals = (DIAGONAL_T *)calloc(5, sizeof(DIAGONAL_T));
+  if (out == NULL || p == NULL || diagonals == NULL) {
+    unmap_containers(in + TRISLE_FILE_HEADER_SIZE,
+                     out != NULL ? out + TRISLE_FILE_HEADER_SIZE : NULL, n,
+                     sizeof(REAL));
+    FREE_IF_NOT_NULL(p);
+    FREE_IF_NOT_NULL(diagonals);
+    return -1; // Failed to map the output or to allocate the system
+  }
+
+  const size_t stride = array_bytes(n, sizeof(REAL));
+  DIAGONAL_T **members[4] = {&p->a, &p->b, &p->c, &p->d};
+  for (size_t k = 0; k < 4; k++) {
+    diagonals[k].n = n;
+    diagonals[k].data = (REAL *)(in + TRISLE_FILE_HEADER_SIZE + k * stride);
+    *members[k] = &diagonals[k];
+  }
+  diagonals[4].n = n;
+  diagonals[4].data = (REAL *)(out + TRISLE_FILE_HEADER_SIZE);
+  p->x = &diagonals[4];
+
+  *sle = p;
+  return 0; // Success
+}
+
+int TRISLE_NAME(map)(TRISLE_T **sle, const char *input, const char *output) {
+  if (sle == NULL) {
+    return -1; // Invalid parameter
+  }
+
+  size_t n = 0;
+  char *in = map_existing(input, sizeof(REAL), TRISLE_LAYOUT_PLANAR, &n);
+  if (in == NULL) {
+    return -1; // Failed to map the input
+  }
+
+  return TRISLE_NAME(map_containers)(sle, in,
+                                     map_output(output, input, n,
+                                                sizeof(REAL)),
+                                     n);
+}
+
+int TRISLE_NAME(map_solved)(TRISLE_T **sle, const char *input,
+                            const char *solution) {
+  if (sle == NULL) {
+    return -1; // Invalid parameter
+  }
+
+  size_t n = 0;
+  char *in = map_existing(input, sizeof(REAL), TRISLE_LAYOUT_PLANAR, &n);
+  if (in == NULL) {
+    return -1; // Failed to map the input
+  }
+
+  return TRISLE_NAME(map_containers)(
+      sle, in, map_existing(solution, sizeof(REAL), TRISLE_LAYOUT_SOLUTION, &n),
+      n);
+}
+
+int TRISLE_NAME(unmap)(TRISLE_T *sle) {
+  if (sle == NULL) {
+    return -1; // Invalid parameter
+  }
+
+  const int ret =
+      unmap_containers(sle->a->data, sle->x->data, sle->b->n, sizeof(REAL));
+
+  FREE_IF_NOT_NULL(sle->a);
+  FREE_IF_NOT_NULL(sle);
+
+  return ret;
+}
+
+#undef REAL
+#undef TRISLE_T
+#undef DIAGONAL_T
+#undef TRISLE_NAME
@@ -0,0 +1,115 @@
+#include "sle_packed.h"
+#include "sle.h"
+#include "util.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PACKED_ALIGNMENT 64
+
+static float *alloc_tiles(size_t tiles) {
+  const size_t bytes = tiles * TRISLE_TILE_FLOATS * sizeof(float);
+  float *p = (float *)aligned_alloc(PACKED_ALIGNMENT,
+                                    bytes > 0 ? bytes : PACKED_ALIGNMENT);
+  if (p == NULL) {
+    return NULL;
+  }
+
+  // Every equation starts as an identity row, so padding is harmless.
+  memset(p, 0, bytes);
+  for (size_t t = 0; t < tiles; t++) {
+    for (size_t lane = 0; lane < TRISLE_TILE; lane++) {
+      p[t * TRISLE_TILE_FLOATS + TRISLE_TILE + lane] = 1.0f;
+    }
+  }
+  return p;
+}
+
+int triSLE_packed_create(triSLE_packed_t **packed, int n) {
+  if (packed == NULL || n < 0) {
+    return -1; // Invalid parameter
+  }
+
+  triSLE_packed_t *p = (triSLE_packed_t *)calloc(1, sizeof(triSLE_packed_t));
+  if (p == NULL) {
+    return -1; // Memory allocation failed
+  }
+
+  p->n = (size_t)n;
+  p->tiles = (p->n + TRISLE_TILE - 1) / TRISLE_TILE;
+  p->data = alloc_tiles(p->tiles);
+  p->scratch = alloc_tiles(p->tiles);
+  p->x = (float *)calloc(p->n > 0 ? p->n : 1, sizeof(float));
+
+  if (p->data == NULL || p->scratch == NULL || p->x == NULL) {
+    triSLE_packed_destroy(p);
+    return -1; // Memory allocation failed
+  }
+
+  *packed = p;
+  return 0; // Success
+}
+
+int triSLE_packed_destroy(triSLE_packed_t *packed) {
+  if (packed == NULL) {
+    return -1; // Invalid parameter
+  }
+
+  FREE_IF_NOT_NULL(packed->data);
+  FREE_IF_NOT_NULL(packed->scratch);
+  FREE_IF_NOT_NULL(packed->x);
+  FREE_IF_NOT_NULL(packed);
+
+  return 0; // Success
+}
+
+int triSLE_pack(triSLE_packed_t *dest, triSLE_t *src) {
+  if (dest == NULL || src == NULL || dest->n != src->b->n) {
+    return -1; // Invalid parameter
+  }
+
+  const float *diagonals[4] = {src->a->data, src->b->data, src->c->data,
+                               src->d->data};
+
+#pragma omp parallel for schedule(static)
+  for (size_t t = 0; t < dest->tiles; t++) {
+    const size_t first = t * TRISLE_TILE;
+    const size_t count =
+        dest->n - first < TRISLE_TILE ? dest->n - first : TRISLE_TILE;
+    float *tile = dest->data + t * TRISLE_TILE_FLOATS;
+
+    for (int k = 0; k < 4; k++) {
+      memcpy(tile + k * TRISLE_TILE, diagonals[k] + first,
+             count * sizeof(float));
+    }
+  }
+
+  return 0; // Success
+}
+
+int triSLE_unpack(triSLE_t *dest, triSLE_packed_t *src) {
+  if (dest == NULL || src == NULL || dest->b->n != src->n) {
+    return -1; // Invalid parameter
+  }
+
+  float *diagonals[4] = {dest->a->data, dest->b->data, dest->c->data,
+                         dest->d->data};
+
+#pragma omp parallel for schedule(static)
+  for (size_t t = 0; t < src->tiles; t++) {
+    const size_t first = t * TRISLE_TILE;
+    const size_t count =
+        src->n - first < TRISLE_TILE ? src->n - first : TRISLE_TILE;
+    const float *tile = src->data + t * TRISLE_TILE_FLOATS;
+
+    for (int k = 0; k < 4; k++) {
+      memcpy(diagonals[k] + first, tile + k * TRISLE_TILE,
+             count * sizeof(float));
+    }
+  }
+
+  memcpy(dest->x->data, src->x, src->n * sizeof(float));
+
+  return 0; // Success
+}
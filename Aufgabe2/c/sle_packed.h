@@ -0,0 +1,137 @@
+/**
+ * @file sle_packed.h
+ * @brief Tridiagonal system stored as interleaved tiles (AoSoA layout).
+ *
+ * triSLE_t keeps a, b, c and d in four separate allocations, so one reduction
+ * step touches twelve independent memory streams. The packed layout groups
+ * TRISLE_TILE consecutive equations into a tile holding their a, b, c and d
+ * values back to back:
+ *
+ * \code
+ * tile t: a[16t .. 16t+15] b[16t .. 16t+15] c[16t .. 16t+15] d[16t .. 16t+15]
+ * \endcode
+ *
+ * All tiles live in one 64 byte aligned allocation, so every SIMD-width group
+ * of coefficients is a single cache line.
+ */
+
+#ifndef SLE_PACKED_H
+#define SLE_PACKED_H
+
+#include "sle.h"
+
+#include <stddef.h>
+
+/**
+ * @brief Number of equations per tile (one AVX-512 register of floats).
+ */
+#define TRISLE_TILE 16
+
+/**
+ * @brief Number of floats per tile (a, b, c and d of TRISLE_TILE equations).
+ */
+#define TRISLE_TILE_FLOATS (4 * TRISLE_TILE)
+
+/**
+ * @brief Index of coefficient k (0 = a, 1 = b, 2 = c, 3 = d) of equation i.
+ */
+#define TRISLE_PACKED_INDEX(i, k)                                              \
+  (((i) / TRISLE_TILE) * TRISLE_TILE_FLOATS + (k) * TRISLE_TILE +              \
+   (i) % TRISLE_TILE)
+
+/**
+ * @struct triSLE_packed_s
+ * @brief Represents a tridiagonal system in the packed tile layout.
+ *
+ * @var triSLE_packed_s::n
+ *   Number of equations.
+ *
+ * @var triSLE_packed_s::tiles
+ *   Number of tiles, i.e. n rounded up to a multiple of TRISLE_TILE divided
+ *   by TRISLE_TILE. Padding equations are identity rows (b = 1).
+ *
+ * @var triSLE_packed_s::data
+ *   Tiles holding a, b, c and d (tiles * TRISLE_TILE_FLOATS floats).
+ *
+ * @var triSLE_packed_s::scratch
+ *   Scratch tiles of the same size used by pcr_packed().
+ *
+ * @var triSLE_packed_s::x
+ *   Solution vector (size n), stored contiguously.
+ */
+struct triSLE_packed_s {
+  size_t n;
+  size_t tiles;
+  float *data;
+  float *scratch;
+
+  float *x;
+};
+
+/**
+ * @typedef triSLE_packed_t
+ * @brief Convenience typedef for struct triSLE_packed_s.
+ */
+typedef struct triSLE_packed_s triSLE_packed_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Create a new packed tridiagonal system.
+ *
+ * @param[out] packed  Pointer to triSLE_packed_t pointer where the new system
+ *                     will be stored. Must not be NULL.
+ * @param[in]  n       Size of the system (number of equations).
+ *
+ * @return 0 on success, non-zero error code on failure.
+ *
+ * @note The caller is responsible for freeing the allocated memory
+ *       using triSLE_packed_destroy().
+ */
+int triSLE_packed_create(triSLE_packed_t **packed, int n);
+
+/**
+ * @brief Destroy a packed system and free its resources.
+ *
+ * @param[in] packed  Pointer to the system to destroy.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ *
+ * @note After calling this function, the pointer becomes invalid
+ *       and should not be used.
+ */
+int triSLE_packed_destroy(triSLE_packed_t *packed);
+
+/**
+ * @brief Convert a system to the packed layout.
+ *
+ * Copies a, b, c and d of src into the tiles of dest. Both systems must have
+ * the same size.
+ *
+ * @param[out] dest  Packed destination system.
+ * @param[in]  src   Source system. Not modified.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int triSLE_pack(triSLE_packed_t *dest, triSLE_t *src);
+
+/**
+ * @brief Convert a packed system back to the separate diagonal layout.
+ *
+ * Copies a, b, c, d and x of src into dest. Both systems must have the same
+ * size.
+ *
+ * @param[out] dest  Destination system.
+ * @param[in]  src   Packed source system. Not modified.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int triSLE_unpack(triSLE_t *dest, triSLE_packed_t *src);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SLE_PACKED_H
@@ -0,0 +1,236 @@
+/**
+ * @file sle_validate_impl.h
+ * @brief Precision-generic validation routines for tridiagonal systems.
+ *
+ * This file is a template that sle.c includes once per precision. Before
+ * inclusion the following macros must be defined:
+ * - REAL:              element type (float or double)
+ * - TRISLE_T:          system type (triSLE_t or triSLE_d_t)
+ * - TRISLE_NAME(name): public function name for the precision
+ *
+ * The macros are undefined again at the end of the file.
+ */
+
+// Row i of A x for the tridiagonal matrix A of system.
+static inline REAL TRISLE_NAME(row_product)(TRISLE_T *system, const REAL *x,
+                                            size_t i) {
+  REAL result = system->b->data[i] * x[i];
+
+  if (i > 0) {
+    result += system->a->data[i] * x[i - 1];
+  }
+
+  if (i < system->b->n - 1) {
+    result += system->c->data[i] * x[i + 1];
+  }
+
+  return result;
+}
+
+// Row i of A x, accumulated in double precision.
+static inline double TRISLE_NAME(row_product_wide)(TRISLE_T *system,
+                                                   const REAL *x, size_t i) {
+  double result = (double)system->b->data[i] * x[i];
+
+  if (i > 0) {
+    result += (double)system->a->data[i] * x[i - 1];
+  }
+
+  if (i < system->b->n - 1) {
+    result += (double)system->c->data[i] * x[i + 1];
+  }
+
+  return result;
+}
+
+int TRISLE_NAME(residual)(TRISLE_T *result_system, TRISLE_T *initial_system,
+                          REAL *residual) {
+  if (result_system == NULL || initial_system == NULL || residual == NULL) {
+    return -1; // Invalid parameter
+  }
+
+#pragma omp parallel for schedule(static)
+  for (size_t i = 0; i < initial_system->b->n; i++) {
+    residual[i] =
+        initial_system->d->data[i] -
+        TRISLE_NAME(row_product)(initial_system, result_system->x->data, i);
+  }
+
+  return 0; // Success
+}
+
+#ifndef TRISLE_VALIDATE_BLOCK
+// Rows per work item of the validation sweep
+#define TRISLE_VALIDATE_BLOCK 4096
+#endif
+
+// Magnitude without a call, so that the sweep vectorizes.
+#define TRISLE_ABS(value) ((value) < 0 ? -(value) : (value))
+
+// Fold a row with the product A x = product (double) and the right-hand side
+// expected into the running measures of TRISLE_NAME(validate)(). Everything
+// is evaluated in double precision, as single precision products of rows with
+// strong cancellation would report their own rounding error.
+#define TRISLE_ACCUMULATE(product, expected)                                   \
+  do {                                                                         \
+    const double expected_ = (expected);                                       \
+    const double residual_ = expected_ - (product);                            \
+    const double abs_residual_ = TRISLE_ABS(residual_);                        \
+    const double relative_ =                                                   \
+        expected_ != 0.0 ? abs_residual_ / TRISLE_ABS(expected_) : 0.0;        \
+    maxrel = relative_ > maxrel ? relative_ : maxrel;                          \
+    sum += expected_ != 0.0 ? relative_ * 100.0                                \
+                            : ((product) != 0.0 ? 1.0 : 0.0);                  \
+    l2 += residual_ * residual_;                                               \
+    inf = abs_residual_ > inf ? abs_residual_ : inf;                           \
+    nans += (product) != (product);                                            \
+  } while (0)
+
+// Measures of the interior rows [lo, hi), which have both neighbours. The
+// loop is branch-free, but gcc only vectorizes its reductions beyond the
+// very cheap cost model of -O2; clones for wider vector units are selected
+// at load time on x86.
+#if defined(__GNUC__) && !defined(__clang__)
+#if defined(__x86_64__)
+__attribute__((target_clones("avx512f", "avx2", "default")))
+#endif
+__attribute__((optimize("vect-cost-model=dynamic")))
+#endif
+static void TRISLE_NAME(validate_rows)(
+    const REAL *restrict a, const REAL *restrict b, const REAL *restrict c,
+    const REAL *restrict d, const REAL *restrict x, size_t lo, size_t hi,
+    double *max_out, double *inf_out, double *sum_out, double *l2_out,
+    int *nans_out) {
+  double maxrel = 0.0, inf = 0.0, sum = 0.0, l2 = 0.0;
+  int nans = 0;
+
+#pragma omp simd reduction(max : maxrel, inf) reduction(+ : sum, l2, nans)
+  for (size_t i = lo; i < hi; i++) {
+    const double product = (double)b[i] * x[i] + (double)a[i] * x[i - 1] +
+                           (double)c[i] * x[i + 1];
+    TRISLE_ACCUMULATE(product, d[i]);
+  }
+
+  *max_out = maxrel;
+  *inf_out = inf;
+  *sum_out = sum;
+  *l2_out = l2;
+  *nans_out = nans;
+}
+
+// Row i of A x for a periodic system, where a[0] couples to x[n - 1] and
+// c[n - 1] to x[0], in double precision.
+static inline double TRISLE_NAME(row_product_periodic)(TRISLE_T *system,
+                                                       const REAL *x,
+                                                       size_t i) {
+  const size_t n = system->b->n;
+  const size_t left = i > 0 ? i - 1 : n - 1;
+  const size_t right = i + 1 < n ? i + 1 : 0;
+
+  return (double)system->a->data[i] * x[left] +
+         (double)system->b->data[i] * x[i] +
+         (double)system->c->data[i] * x[right];
+}
+
+static int TRISLE_NAME(validate_system)(TRISLE_T *result_system,
+                                        TRISLE_T *initial_system, int periodic,
+                                        triSLE_validation_t *validation) {
+  if (result_system == NULL || initial_system == NULL || validation == NULL) {
+    return -1; // Invalid parameter
+  }
+
+  const size_t n = initial_system->b->n;
+  const REAL *a = initial_system->a->data;
+  const REAL *b = initial_system->b->data;
+  const REAL *c = initial_system->c->data;
+  const REAL *d = initial_system->d->data;
+  const REAL *x = result_system->x->data;
+
+  const size_t interior = n > 2 ? n - 2 : 0;
+  const size_t blocks =
+      (interior + TRISLE_VALIDATE_BLOCK - 1) / TRISLE_VALIDATE_BLOCK;
+
+  double maxrel = 0.0, sum = 0.0, l2 = 0.0, inf = 0.0;
+  int nans = 0;
+
+#pragma omp parallel for schedule(static)                                      \
+    reduction(max : maxrel, inf) reduction(+ : sum, l2, nans)
+  for (size_t blk = 0; blk < blocks; blk++) {
+    const size_t lo = 1 + blk * TRISLE_VALIDATE_BLOCK;
+    const size_t hi =
+        lo + TRISLE_VALIDATE_BLOCK < n - 1 ? lo + TRISLE_VALIDATE_BLOCK : n - 1;
+    double block_max, block_inf, block_sum, block_l2;
+    int block_nans;
+
+    TRISLE_NAME(validate_rows)(a, b, c, d, x, lo, hi, &block_max, &block_inf,
+                               &block_sum, &block_l2, &block_nans);
+    maxrel = block_max > maxrel ? block_max : maxrel;
+    inf = block_inf > inf ? block_inf : inf;
+    sum += block_sum;
+    l2 += block_l2;
+    nans += block_nans;
+  }
+
+  // Only the boundary rows differ for periodic systems
+  if (n > 0) {
+    const double first =
+        periodic ? TRISLE_NAME(row_product_periodic)(initial_system, x, 0)
+                 : TRISLE_NAME(row_product_wide)(initial_system, x, 0);
+    TRISLE_ACCUMULATE(first, d[0]);
+  }
+  if (n > 1) {
+    const double last =
+        periodic ? TRISLE_NAME(row_product_periodic)(initial_system, x, n - 1)
+                 : TRISLE_NAME(row_product_wide)(initial_system, x, n - 1);
+    TRISLE_ACCUMULATE(last, d[n - 1]);
+  }
+
+  // A NaN anywhere in the solution poisons the maximum, as the solvers give
+  // no other indication of a breakdown.
+  validation->maxrel = nans > 0 ? 0.0 / 0.0 : maxrel;
+  validation->mape = n > 0 ? sum / (double)n : 0.0;
+  validation->residual_l2 = sqrt(l2);
+  validation->residual_inf = inf;
+
+  return 0; // Success
+}
+
+int TRISLE_NAME(validate)(TRISLE_T *result_system, TRISLE_T *initial_system,
+                          triSLE_validation_t *validation) {
+  return TRISLE_NAME(validate_system)(result_system, initial_system, 0,
+                                      validation);
+}
+
+int TRISLE_NAME(validate_periodic)(TRISLE_T *result_system,
+                                   TRISLE_T *initial_system,
+                                   triSLE_validation_t *validation) {
+  return TRISLE_NAME(validate_system)(result_system, initial_system, 1,
+                                      validation);
+}
+
+#undef TRISLE_ACCUMULATE
+#undef TRISLE_ABS
+
+REAL TRISLE_NAME(validate_maxrel)(TRISLE_T *result_system,
+                                  TRISLE_T *initial_system) {
+  triSLE_validation_t validation;
+  if (TRISLE_NAME(validate)(result_system, initial_system, &validation) != 0) {
+    return 0.0 / 0.0;
+  }
+
+  return (REAL)validation.maxrel;
+}
+
+REAL TRISLE_NAME(validate_mape)(TRISLE_T *result_system,
+                                TRISLE_T *initial_system) {
+  triSLE_validation_t validation;
+  if (TRISLE_NAME(validate)(result_system, initial_system, &validation) != 0) {
+    return 0.0 / 0.0;
+  }
+
+  return (REAL)validation.mape;
+}
+
+#undef REAL
+#undef TRISLE_T
+#undef TRISLE_NAME
@@ -7,8 +7,13 @@
 #ifndef SOLVER_H
 #define SOLVER_H
 
+#include "batch.h"
+#include "factor.h"
 #include "sle.h"
+#include "sle_block.h"
+#include "sle_packed.h"
 #include "util.h"
+#include "workspace.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -39,17 +44,416 @@ extern "C" {
  *
  * @return 0 on success, non-zero error code on failure.
  *
- * @note This implementation uses OpenMP for parallelization on CPU.
+ * @note This implementation uses OpenMP for parallelization on CPU. All
+ *       levels run in a single parallel region that synchronizes with one
+ *       barrier per level.
+ * @note The diagonals a, b, c and d are used as work space; their content is
+ *       unspecified after the call.
  *
  * @see pcr_gpu() for GPU-accelerated implementation.
  */
 int pcr(triSLE_t *sle, timer *start, timer *end);
 
+/**
+ * @brief Solve a double precision tridiagonal system using Parallel Cyclic
+ * Reduction (CPU implementation).
+ *
+ * Performs the same reduction as pcr() in double precision. The reduction
+ * step is generated from the same template as the single precision one.
+ *
+ * @param[in,out] sle    Pointer to the tridiagonal system to solve.
+ *                       On input, contains coefficients and RHS.
+ *                       On output, contains solution in sle->x.
+ * @param[out]    start  Timer to record the start time.
+ * @param[out]    end    Timer to record the end time.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ *
+ * @note The diagonals a, b, c and d are used as work space; their content is
+ *       unspecified after the call.
+ */
+int pcr_d(triSLE_d_t *sle, timer *start, timer *end);
+
+/**
+ * @brief Solve a double precision tridiagonal system using single precision
+ * Parallel Cyclic Reduction and iterative refinement.
+ *
+ * The system is rounded to single precision and solved with pcr_ws(). Each
+ * refinement step then computes the residual r = d - A x in double precision,
+ * solves A e = r in single precision and updates x += e. For well conditioned
+ * systems a few steps recover double precision accuracy while the solves run
+ * at single precision speed.
+ *
+ * @param[in,out] sle         Pointer to the tridiagonal system to solve.
+ *                            On input, contains coefficients and RHS.
+ *                            On output, contains solution in sle->x.
+ * @param[in]     iterations  Number of refinement steps (0 for a plain
+ *                            single precision solve).
+ * @param[out]    start       Timer to record the start time.
+ * @param[out]    end         Timer to record the end time.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ *
+ * @note Unlike the other solvers, a, b, c and d are not modified.
+ */
+int pcr_mixed(triSLE_d_t *sle, int iterations, timer *start, timer *end);
+
+/**
+ * @brief Solve a tridiagonal system using the Thomas algorithm (sequential
+ * reference implementation).
+ *
+ * Performs one forward elimination and one backward substitution sweep over
+ * the system, i.e. O(n) work on a single thread. It serves as the baseline
+ * against which the extra O(n log n) work of the PCR variants is judged.
+ *
+ * @param[in,out] sle    Pointer to the tridiagonal system to solve.
+ *                       On input, contains coefficients and RHS.
+ *                       On output, contains solution in sle->x.
+ * @param[out]    start  Timer to record the start time.
+ * @param[out]    end    Timer to record the end time.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ *
+ * @note The diagonals c and d are overwritten with the forward-sweep
+ *       coefficients. No pivoting is performed.
+ *
+ * @see pcr() for the parallel implementation.
+ */
+int thomas(triSLE_t *sle, timer *start, timer *end);
+
+/**
+ * @brief Solve a tridiagonal system using Parallel Cyclic Reduction with a
+ * caller-provided workspace (CPU implementation).
+ *
+ * Performs the same reduction as pcr(), but takes its temporary diagonals
+ * from a workspace created once with pcr_workspace_create(). The call does not
+ * allocate memory. The reduction alternates between the system's diagonals
+ * and the workspace by swapping local pointers only, and the last level is
+ * fused with the computation of x, so no copy-back is performed for any n.
+ *
+ * @param[in,out] sle    Pointer to the tridiagonal system to solve.
+ *                       On input, contains coefficients and RHS.
+ *                       On output, contains solution in sle->x.
+ * @param[in,out] ws     Workspace with ws->max_n >= sle->b->n.
+ * @param[out]    start  Timer to record the start time.
+ * @param[out]    end    Timer to record the end time.
+ *
+ * @return 0 on success, non-zero error code on failure (e.g., workspace too
+ *         small).
+ *
+ * @note The diagonals a, b, c and d are used as work space; their content is
+ *       unspecified after the call.
+ *
+ * @see pcr() for a variant that manages its own temporary memory.
+ */
+int pcr_ws(triSLE_t *sle, pcr_workspace_t *ws, timer *start, timer *end);
+
+/**
+ * @brief Solve a tridiagonal system using division-free Parallel Cyclic
+ * Reduction (CPU implementation).
+ *
+ * Performs the same reduction as pcr(), but multiplies by the reciprocals of
+ * the neighbouring b instead of dividing by them, and obtains x = d / b of
+ * the last level the same way. The reciprocals are computed in registers from
+ * the approximate reciprocal instruction refined with Newton's method (or,
+ * without SIMD, from an exponent estimate and three Newton steps), so no row
+ * divides and every level moves the same data as in pcr().
+ *
+ * @param[in,out] sle    Pointer to the tridiagonal system to solve.
+ *                       On input, contains coefficients and RHS.
+ *                       On output, contains solution in sle->x.
+ * @param[out]    start  Timer to record the start time.
+ * @param[out]    end    Timer to record the end time.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ *
+ * @note The result differs from pcr() by a few units in the last place per
+ *       level; use triSLE_validate() to measure the effect on a system.
+ * @note The diagonals a, b, c and d are used as work space; their content is
+ *       unspecified after the call.
+ */
+int pcr_fast(triSLE_t *sle, timer *start, timer *end);
+
+/**
+ * @brief Solve a tridiagonal system using cache-blocked Parallel Cyclic
+ * Reduction (CPU implementation).
+ *
+ * The first levels, whose strides are small, are fused into one tiled pass:
+ * every tile of the system is loaded into a per-thread buffer of the workspace
+ * together with a halo of 2^levels - 1 equations on both sides and reduced
+ * levels times while it is cache resident. Only the remaining large-stride
+ * levels are performed as global sweeps as in pcr_ws(). This replaces levels
+ * round trips to main memory by one.
+ *
+ * @param[in,out] sle     Pointer to the tridiagonal system to solve.
+ *                        On input, contains coefficients and RHS.
+ *                        On output, contains solution in sle->x.
+ * @param[in,out] ws      Workspace with ws->max_n >= sle->b->n.
+ * @param[in]     levels  Number of fused levels, or <= 0 for the default.
+ *                        At most PCR_FUSED_MAX_LEVELS are fused, and the
+ *                        last level never.
+ * @param[out]    start   Timer to record the start time.
+ * @param[out]    end     Timer to record the end time.
+ *
+ * @return 0 on success, non-zero error code on failure (e.g., workspace too
+ *         small).
+ *
+ * @note The diagonals a, b, c and d are used as work space; their content is
+ *       unspecified after the call.
+ */
+int pcr_fused(triSLE_t *sle, pcr_workspace_t *ws, int levels, timer *start,
+              timer *end);
+
+/**
+ * @brief Solve a tridiagonal system with a hybrid of Parallel Cyclic
+ * Reduction and the Thomas algorithm (CPU implementation).
+ *
+ * Runs only the first k PCR levels. Afterwards, row i is coupled only to the
+ * rows i - 2^k and i + 2^k, so the system has split into 2^k independent
+ * interleaved subsystems of about n / 2^k equations each. These are solved
+ * with sequential Thomas sweeps, distributed over the OpenMP threads. This
+ * reduces the work from O(n log n) to O(n k + n).
+ *
+ * If levels is not positive, k is chosen as the smallest depth that yields
+ * enough subsystems to keep every thread busy with full cache lines. Values
+ * larger than the number of levels of plain PCR are clamped.
+ *
+ * @param[in,out] sle     Pointer to the tridiagonal system to solve.
+ *                        On input, contains coefficients and RHS.
+ *                        On output, contains solution in sle->x.
+ * @param[in,out] ws      Workspace with ws->max_n >= sle->b->n.
+ * @param[in]     levels  Number of PCR levels k, or <= 0 for automatic.
+ * @param[out]    start   Timer to record the start time.
+ * @param[out]    end     Timer to record the end time.
+ *
+ * @return 0 on success, non-zero error code on failure (e.g., workspace too
+ *         small).
+ *
+ * @note The diagonals a, b, c and d are used as work space; their content is
+ *       unspecified after the call.
+ *
+ * @note The Thomas sweeps do not pivot. Like pcr(), they are intended for
+ *       diagonally dominant systems.
+ */
+int pcr_thomas(triSLE_t *sle, pcr_workspace_t *ws, int levels, timer *start,
+               timer *end);
+
+/**
+ * @brief Solve a tridiagonal system stored in the packed tile layout using
+ * Parallel Cyclic Reduction (CPU implementation).
+ *
+ * Performs the same reduction as pcr() on a triSLE_packed_t. Each step reads
+ * the tiles of the equation and of its two neighbours, i.e. three streams
+ * instead of twelve. Once the stride is a multiple of TRISLE_TILE, each tile
+ * is reduced as a whole from complete neighbour tiles. The reduction
+ * alternates between sle->data and sle->scratch, so no memory is allocated.
+ *
+ * @param[in,out] sle    Pointer to the packed system to solve.
+ *                       On input, contains coefficients and RHS.
+ *                       On output, contains solution in sle->x.
+ * @param[out]    start  Timer to record the start time.
+ * @param[out]    end    Timer to record the end time.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ *
+ * @note The tiles in sle->data are used as work space; their content is
+ *       unspecified after the call.
+ *
+ * @see triSLE_pack() and triSLE_unpack() to convert from and to triSLE_t.
+ */
+int pcr_packed(triSLE_packed_t *sle, timer *start, timer *end);
+
+/**
+ * @brief Solve a batch of independent tridiagonal systems using Parallel
+ * Cyclic Reduction (CPU implementation).
+ *
+ * Solves every system of the batch with the same reduction as pcr(). The
+ * whole batch is processed in a single OpenMP parallel region and uses the
+ * scratch diagonals allocated with the batch, so no memory is allocated per
+ * call. If the batch holds at least as many systems as there are threads, the
+ * systems are distributed over the threads and each one is solved
+ * sequentially; otherwise all threads work together on one system at a time.
+ *
+ * The solution of system k is stored in batch->x at the rows
+ * [batch->offsets[k], batch->offsets[k + 1]).
+ *
+ * @param[in,out] batch  Pointer to the batch to solve.
+ *                       On input, contains coefficients and RHS.
+ *                       On output, contains the solutions in batch->x.
+ * @param[out]    start  Timer to record the start time.
+ * @param[out]    end    Timer to record the end time.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ *
+ * @note The diagonals a, b, c and d are used as work space; their content is
+ *       unspecified after the call.
+ *
+ * @see pcr() for a single system.
+ */
+int pcr_batched(triSLE_batch_t *batch, timer *start, timer *end);
+
+/**
+ * @brief Solve a periodic (cyclic) tridiagonal system using Parallel Cyclic
+ * Reduction (CPU implementation).
+ *
+ * In a periodic system the otherwise unused a[0] couples the first row to
+ * x[n - 1] and c[n - 1] the last row to x[0]. If n is a power of two, the
+ * reduction of pcr() runs with the neighbour indices taken modulo n, which
+ * needs no extra solve: after log2(n) - 1 levels, rows i and i + n / 2 form
+ * independent 2x2 systems. Other sizes are solved with the Sherman-Morrison
+ * formula from one factorization of the non-periodic part and two
+ * right-hand sides (see pcr_factorize()).
+ *
+ * @param[in,out] sle    Pointer to the periodic system to solve.
+ *                       On input, contains coefficients and RHS.
+ *                       On output, contains solution in sle->x.
+ * @param[out]    start  Timer to record the start time.
+ * @param[out]    end    Timer to record the end time.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ *
+ * @note For powers of two, the diagonals a, b, c and d are used as work
+ *       space; their content is unspecified after the call.
+ *
+ * @see triSLE_validate_periodic()
+ */
+int pcr_periodic(triSLE_t *sle, timer *start, timer *end);
+
+/**
+ * @brief Solve a block-tridiagonal system using Parallel Cyclic Reduction
+ * (CPU implementation).
+ *
+ * Runs the reduction of pcr() with m x m blocks in place of the scalar
+ * coefficients and the block inverses of the main diagonal in place of the
+ * divisions. Every level first inverts all main diagonal blocks in one
+ * batched pass and then reduces all block rows, each thread working on its
+ * static range in a single parallel region. The block operations are
+ * specialized and unrolled for every block size up to TRISLE_BLOCK_MAX.
+ *
+ * @param[in,out] sle    Pointer to the block system to solve.
+ *                       On input, contains coefficients and RHS.
+ *                       On output, contains solution in sle->x.
+ * @param[out]    start  Timer to record the start time.
+ * @param[out]    end    Timer to record the end time.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ *
+ * @note The blocks are inverted by Gauss-Jordan elimination with partial
+ *       pivoting, without further safeguards; the main diagonal blocks of
+ *       every level must be well conditioned, as for block diagonally
+ *       dominant matrices.
+ * @note The diagonals a, b, c and d are used as work space; their content is
+ *       unspecified after the call.
+ *
+ * @see triSLE_block_validate()
+ */
+int pcr_block(triSLE_block_t *sle, timer *start, timer *end);
+
+/**
+ * @brief Factorize a tridiagonal matrix for solves with many right-hand
+ * sides.
+ *
+ * Runs the reduction of pcr() on a, b and c only and stores the decoupling
+ * coefficients of every level in factor. d is not used.
+ *
+ * @param[in,out] sle     Pointer to the system whose matrix is factorized.
+ * @param[in]     ws      Workspace with max_n >= sle->b->n.
+ * @param[out]    factor  Factorization created for sle->b->n equations.
+ * @param[out]    start   Timer to record the start time.
+ * @param[out]    end     Timer to record the end time.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ *
+ * @note The diagonals a, b and c are used as work space; their content is
+ *       unspecified after the call.
+ *
+ * @see pcr_factor_solve()
+ */
+int pcr_factorize(triSLE_t *sle, pcr_workspace_t *ws, pcr_factor_t *factor,
+                  timer *start, timer *end);
+
+/**
+ * @brief Solve a factorized system for k right-hand sides at once.
+ *
+ * Applies the stored coefficients of every level to all right-hand sides of
+ * a row in one vectorized loop, so each level costs three loads and two
+ * multiply-adds per value. Only the last level also divides by the final
+ * main diagonal.
+ *
+ * The right-hand sides are stored row-major: value j of row i is at
+ * rhs[i * k + j], and the solutions are stored the same way in x.
+ *
+ * @param[in]     factor   Factorization from pcr_factorize().
+ * @param[in,out] rhs      Array of n * k right-hand side values.
+ * @param[out]    scratch  Array of n * k values used as work space.
+ * @param[out]    x        Array of n * k values receiving the solutions.
+ * @param[in]     k        Number of right-hand sides.
+ * @param[out]    start    Timer to record the start time.
+ * @param[out]    end      Timer to record the end time.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ *
+ * @note The content of rhs is unspecified after the call.
+ */
+int pcr_factor_solve(const pcr_factor_t *factor, float *rhs, float *scratch,
+                     float *x, int k, timer *start, timer *end);
+
+/**
+ * @brief Solve a system stored in a container chunk by chunk (out-of-core).
+ *
+ * The system is streamed from the input container in chunks of rows
+ * equations, each split into one part per OpenMP thread and eliminated as in
+ * pcr_mpi() (see partition.h). The reduced system of one row per part is
+ * solved in memory with pcr(). A second pass reads the chunks again,
+ * recomputes their local coefficients and writes the solution to the output
+ * container. In both passes the transfer of the next (and previous) chunk
+ * overlaps the computation of the current one.
+ *
+ * Memory use is bounded by about 13 * rows floats plus 15 floats per part,
+ * independently of n, so n may exceed the main memory.
+ *
+ * @param[in]  input   Path of a single precision system container (see
+ *                     sle_io.h). Not modified.
+ * @param[in]  output  Path of the solution container to create. Must not be
+ *                     the input; it is only created or truncated once the
+ *                     input header has been checked.
+ * @param[in]  rows    Number of equations per chunk.
+ * @param[out] start   Timer to record the start time.
+ * @param[out] end     Timer to record the end time.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ *
+ * @note The solve reads the input twice, so its time is dominated by the
+ *       I/O throughput for large n.
+ */
+int pcr_stream(const char *input, const char *output, size_t rows,
+               timer *start, timer *end);
+
+/**
+ * @brief Name of the reduction kernel used by the CPU PCR solvers.
+ *
+ * The CPU solvers reduce the interior equations of every level with the
+ * widest SIMD kernel the processor supports (avx512, avx2, neon or scalar),
+ * detected at runtime. The environment variable PCR_SIMD can request a
+ * narrower kernel, e.g. for comparisons.
+ *
+ * @return Name of the selected kernel.
+ */
+const char *pcr_kernel_name(void);
+
 /**
  * @brief Solve a tridiagonal system using Parallel Cyclic Reduction (GPU
  * implementation).
  *
- * TODO: This is your job :-)
+ * Runs the same log(n) reduction stages as pcr() with one CUDA thread per
+ * equation. Each stage reads from one set of device buffers and writes into a
+ * second set; the two sets trade roles between stages, so no host-side pointer
+ * swaps or copy-back are needed. Only sle->x is copied back to the host, the
+ * host copies of a, b, c and d are left untouched.
+ *
+ * Device buffers are allocated on first use and kept for subsequent calls.
+ * They are only reallocated when a larger system is solved and can be
+ * released explicitly with pcr_gpu_release().
  *
  * The input system must have all matrices initialized:
  * - sle->a: lower diagonal
@@ -73,6 +477,34 @@ int pcr(triSLE_t *sle, timer *start, timer *end);
  */
 int pcr_gpu(triSLE_t *sle, timer *start, timer *end);
 
+/**
+ * @brief Solve a tridiagonal system with fast divisions on the GPU.
+ *
+ * As pcr_gpu(), but all divisions use the __fdividef() intrinsic, a
+ * reciprocal approximation followed by a multiplication, instead of
+ * IEEE-compliant division. As in pcr_fast(), no reciprocals are stored, so
+ * the memory traffic equals that of pcr_gpu().
+ *
+ * @param[in,out] sle    Pointer to the tridiagonal system to solve.
+ *                       On output, contains solution in sle->x.
+ * @param[out]    start  Timer to record the start time.
+ * @param[out]    end    Timer to record the end time.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ *
+ * @note __fdividef(x, y) returns 0 for 2^126 < |y| < 2^128.
+ */
+int pcr_gpu_fast(triSLE_t *sle, timer *start, timer *end);
+
+/**
+ * @brief Release the device buffers kept by pcr_gpu().
+ *
+ * @return 0 on success, non-zero error code on failure.
+ *
+ * @note Calling pcr_gpu() afterwards is allowed and allocates new buffers.
+ */
+int pcr_gpu_release(void);
+
 #ifdef __cplusplus
 }
 #endif
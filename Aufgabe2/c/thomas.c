@@ -0,0 +1,26 @@
+#include "pcr_kernel.h"
+#include "sle.h"
+#include "solver.h"
+#include "util.h"
+
+#include <stddef.h>
+
+int thomas(triSLE_t *sle, timer *start, timer *end) {
+  if (sle == NULL) {
+    return -1;
+  }
+  size_t n = sle->b->n;
+  if (n == 0) {
+    return 0; // Nothing to do
+  }
+
+  TIME_GET(*start);
+
+  // A single subsystem with stride 1 is the classic Thomas algorithm.
+  thomas_interleaved(sle->a->data, sle->b->data, sle->c->data, sle->d->data,
+                     sle->x->data, (int)n, 1, 0, 1);
+
+  TIME_GET(*end);
+
+  return 0;
+}
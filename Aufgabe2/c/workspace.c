@@ -0,0 +1,73 @@
+#include "workspace.h"
+#include "diagonal.h"
+#include "util.h"
+
+#include <omp.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Tile buffers of different threads start on separate cache lines
+#define TILE_ALIGN_FLOATS 16
+
+int pcr_workspace_create(pcr_workspace_t **ws, int max_n) {
+  if (ws == NULL || max_n < 0) {
+    return -1; // Invalid parameter
+  }
+
+  pcr_workspace_t *p = (pcr_workspace_t *)calloc(1, sizeof(pcr_workspace_t));
+  if (p == NULL) {
+    return -1; // Memory allocation failed
+  }
+
+  p->max_n = (size_t)max_n;
+
+  for (int k = 0; k < 4; k++) {
+    if (diagonal_create(&p->tmp[k], max_n) != 0) {
+      pcr_workspace_destroy(p);
+      return -1; // Memory allocation failed
+    }
+  }
+
+  // A tile never extends beyond the system, so small workspaces get small
+  // tile buffers.
+  size_t span = PCR_FUSED_TILE + 2 * (((size_t)1 << PCR_FUSED_MAX_LEVELS) - 1);
+  if (span > (size_t)max_n) {
+    span = max_n > 0 ? (size_t)max_n : 1;
+  }
+  span = (span + TILE_ALIGN_FLOATS - 1) / TILE_ALIGN_FLOATS * TILE_ALIGN_FLOATS;
+
+  p->tile_span = span;
+  p->tile_threads = omp_get_max_threads();
+  p->tiles =
+      (float *)malloc((size_t)p->tile_threads * 8 * span * sizeof(float));
+  if (p->tiles == NULL) {
+    pcr_workspace_destroy(p);
+    return -1; // Memory allocation failed
+  }
+
+  // First touch by the thread that will work on the buffer
+#pragma omp parallel num_threads(p->tile_threads)
+  memset(p->tiles + (size_t)omp_get_thread_num() * 8 * span, 0,
+         8 * span * sizeof(float));
+
+  *ws = p;
+  return 0; // Success
+}
+
+int pcr_workspace_destroy(pcr_workspace_t *ws) {
+  if (ws == NULL) {
+    return -1; // Invalid parameter
+  }
+
+  for (int k = 0; k < 4; k++) {
+    if (ws->tmp[k] != NULL) {
+      diagonal_destroy(ws->tmp[k]);
+    }
+  }
+
+  FREE_IF_NOT_NULL(ws->tiles);
+  FREE_IF_NOT_NULL(ws);
+
+  return 0; // Success
+}
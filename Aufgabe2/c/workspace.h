@@ -0,0 +1,105 @@
+/**
+ * @file workspace.h
+ * @brief Reusable scratch memory for the PCR solver.
+ *
+ * This header defines a workspace that holds the temporary diagonals needed
+ * by the reduction and the per-thread tile buffers of pcr_fused(). A
+ * workspace is created once for the largest system size and can then be
+ * passed to pcr_ws() or pcr_fused() for any number of solves without further
+ * memory allocation.
+ */
+
+#ifndef WORKSPACE_H
+#define WORKSPACE_H
+
+#include "diagonal.h"
+
+#include <stddef.h>
+
+/**
+ * @brief Equations per tile of pcr_fused().
+ *
+ * Two buffer sets of a tile plus halo take 8 * (PCR_FUSED_TILE + 2 * halo)
+ * floats, about 130 KiB for the default depth, which stays resident in L2.
+ */
+#define PCR_FUSED_TILE 4096
+
+/**
+ * @brief Largest number of levels pcr_fused() fuses into its tiled pass.
+ *
+ * The tile buffers of a workspace are sized for this depth.
+ */
+#define PCR_FUSED_MAX_LEVELS 8
+
+/**
+ * @struct pcr_workspace_s
+ * @brief Scratch memory for solving systems of up to max_n equations.
+ *
+ * @var pcr_workspace_s::max_n
+ *   Largest number of equations the workspace can be used for.
+ *
+ * @var pcr_workspace_s::tmp
+ *   Scratch diagonals for a, b, c and d (size max_n each).
+ *
+ * @var pcr_workspace_s::tiles
+ *   Tile buffers of pcr_fused(), 8 * tile_span floats per thread.
+ *
+ * @var pcr_workspace_s::tile_span
+ *   Floats per diagonal of a tile buffer, enough for a tile of up to
+ *   PCR_FUSED_MAX_LEVELS fused levels with its halo.
+ *
+ * @var pcr_workspace_s::tile_threads
+ *   Number of threads the tile buffers are sized for.
+ */
+struct pcr_workspace_s {
+  size_t max_n;
+  diagonal_t *tmp[4];
+  float *tiles;
+  size_t tile_span;
+  int tile_threads;
+};
+
+/**
+ * @typedef pcr_workspace_t
+ * @brief Convenience typedef for struct pcr_workspace_s.
+ */
+typedef struct pcr_workspace_s pcr_workspace_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Create a new solver workspace.
+ *
+ * @param[out] ws     Pointer to pcr_workspace_t pointer where the new
+ *                    workspace will be stored. Must not be NULL.
+ * @param[in]  max_n  Largest system size the workspace will be used for.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ *
+ * @note The tile buffers are sized for omp_get_max_threads() at the time of
+ *       the call; pcr_fused() uses at most that many threads.
+ *
+ * @note The caller is responsible for freeing the allocated memory
+ *       using pcr_workspace_destroy().
+ */
+int pcr_workspace_create(pcr_workspace_t **ws, int max_n);
+
+/**
+ * @brief Destroy a solver workspace and free its resources.
+ *
+ * @param[in] ws  Pointer to the workspace to destroy.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ *
+ * @note After calling this function, the pointer becomes invalid
+ *       and should not be used.
+ */
+int pcr_workspace_destroy(pcr_workspace_t *ws);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WORKSPACE_H
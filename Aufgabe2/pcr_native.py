@@ -0,0 +1,260 @@
+"""
+Bindings of the parallel C implementation of the PCR algorithm in c/.
+
+The diagonals are handed to the C solvers as they are: float32 arrays, which
+are contiguous, are passed by pointer without any copy, all others are
+converted once. No dense matrix is built. Build the shared library first with
+
+    make -C c libpcr.so        (or libpcr_gpu.so for solve_gpu)
+
+The library is loaded from c/libpcr.so next to this file, or from the path in
+the environment variable PCR_LIBRARY. The number of threads is controlled by
+OMP_NUM_THREADS as for the C programs.
+"""
+
+import ctypes
+import os
+
+import numpy as np
+
+
+class _diagonal(ctypes.Structure):
+    """Mirror of diagonal_t in c/diagonal.h."""
+
+    _fields_ = [("n", ctypes.c_size_t), ("data", ctypes.POINTER(ctypes.c_float))]
+
+
+class _triSLE(ctypes.Structure):
+    """Mirror of triSLE_t in c/sle.h."""
+
+    _fields_ = [
+        ("a", ctypes.POINTER(_diagonal)),
+        ("b", ctypes.POINTER(_diagonal)),
+        ("c", ctypes.POINTER(_diagonal)),
+        ("d", ctypes.POINTER(_diagonal)),
+        ("x", ctypes.POINTER(_diagonal)),
+    ]
+
+
+class _triSLE_batch(ctypes.Structure):
+    """Mirror of triSLE_batch_t in c/batch.h."""
+
+    _fields_ = [
+        ("count", ctypes.c_size_t),
+        ("offsets", ctypes.POINTER(ctypes.c_size_t)),
+        ("max_n", ctypes.c_size_t),
+        ("a", ctypes.POINTER(_diagonal)),
+        ("b", ctypes.POINTER(_diagonal)),
+        ("c", ctypes.POINTER(_diagonal)),
+        ("d", ctypes.POINTER(_diagonal)),
+        ("x", ctypes.POINTER(_diagonal)),
+        ("tmp", ctypes.POINTER(_diagonal) * 4),
+    ]
+
+
+class _timer(ctypes.Structure):
+    """Mirror of timer (struct timespec) in c/util.h."""
+
+    _fields_ = [("tv_sec", ctypes.c_long), ("tv_nsec", ctypes.c_long)]
+
+
+def _load_library():
+    path = os.environ.get(
+        "PCR_LIBRARY", os.path.join(os.path.dirname(__file__), "c", "libpcr.so")
+    )
+    lib = ctypes.CDLL(path)
+
+    sle_solver = [
+        ctypes.POINTER(_triSLE),
+        ctypes.POINTER(_timer),
+        ctypes.POINTER(_timer),
+    ]
+    lib.pcr.argtypes = sle_solver
+    lib.pcr.restype = ctypes.c_int
+    lib.pcr_batched.argtypes = [
+        ctypes.POINTER(_triSLE_batch),
+        ctypes.POINTER(_timer),
+        ctypes.POINTER(_timer),
+    ]
+    lib.pcr_batched.restype = ctypes.c_int
+    if hasattr(lib, "pcr_gpu"):
+        lib.pcr_gpu.argtypes = sle_solver
+        lib.pcr_gpu.restype = ctypes.c_int
+    return lib
+
+
+_lib = _load_library()
+
+
+def _as_float32(array, name, n, copy):
+    """Returns array as contiguous float32 vector of length n.
+
+    Without copy, the array itself is returned if it already has this layout,
+    so the C solver works on its memory.
+    """
+    if copy:
+        result = np.array(array, dtype=np.float32, order="C", copy=True)
+    else:
+        result = np.require(array, dtype=np.float32, requirements=["C", "W"])
+    if result.ndim != 1 or result.shape[0] != n:
+        raise ValueError(f"{name} must be a vector of length {n}")
+    return result
+
+
+def _output(out, n):
+    """Returns the solution vector, allocating it if out is None."""
+    if out is None:
+        return np.empty(n, dtype=np.float32)
+    if (
+        out.dtype != np.float32
+        or out.ndim != 1
+        or out.shape[0] != n
+        or not out.flags.c_contiguous
+        or not out.flags.writeable
+    ):
+        raise ValueError(f"out must be a writable float32 vector of length {n}")
+    return out
+
+
+def _diagonal_of(array):
+    """Wraps a float32 vector as diagonal_t without copying."""
+    return _diagonal(
+        array.shape[0], array.ctypes.data_as(ctypes.POINTER(ctypes.c_float))
+    )
+
+
+def _system(a, b, c, d, out, overwrite):
+    """Prepares the diagonals and the solution vector of a system.
+
+    Returns the arrays, which must be kept alive during the solve, and the
+    diagonal_t structures referring to them.
+    """
+    n = np.shape(b)[0]
+    arrays = [
+        _as_float32(a, "a", n, not overwrite),
+        _as_float32(b, "b", n, not overwrite),
+        _as_float32(c, "c", n, not overwrite),
+        _as_float32(d, "d", n, not overwrite),
+        _output(out, n),
+    ]
+    return arrays, [_diagonal_of(array) for array in arrays]
+
+
+def _check(status, solver):
+    if status != 0:
+        raise RuntimeError(f"{solver} failed with status {status}")
+
+
+def solve(a, b, c, d, out=None, overwrite=False):
+    """Solves a tridiagonal system with the parallel C implementation of PCR.
+
+    Row i of the system reads a[i] x[i - 1] + b[i] x[i] + c[i] x[i + 1] = d[i];
+    a[0] and c[n - 1] must be zero. The computation is done in single
+    precision.
+
+    Args:
+        a (np.ndarray): Lower diagonal, length n.
+        b (np.ndarray): Main diagonal, length n.
+        c (np.ndarray): Upper diagonal, length n.
+        d (np.ndarray): Right-hand side, length n.
+        out (np.ndarray, optional): Contiguous float32 vector of length n that
+            receives the solution. Allocated if None.
+        overwrite (bool, optional): Let the solver work directly on a, b, c
+            and d, which must then be contiguous float32 vectors to avoid a
+            copy. Their content is unspecified afterwards. Default is False,
+            which leaves the inputs untouched.
+
+    Returns:
+        np.ndarray: Solution vector x (float32).
+    """
+    arrays, diagonals = _system(a, b, c, d, out, overwrite)
+    sle = _triSLE(*[ctypes.pointer(diagonal) for diagonal in diagonals])
+    start, end = _timer(), _timer()
+    _check(
+        _lib.pcr(ctypes.byref(sle), ctypes.byref(start), ctypes.byref(end)),
+        "pcr",
+    )
+    return arrays[4]
+
+
+def solve_gpu(a, b, c, d, out=None):
+    """Solves a tridiagonal system with the CUDA implementation of PCR.
+
+    Same system as for solve(). The inputs are only read, so float32
+    contiguous vectors are never copied on the host. Requires PCR_LIBRARY to
+    point to c/libpcr_gpu.so.
+
+    Args:
+        a (np.ndarray): Lower diagonal, length n.
+        b (np.ndarray): Main diagonal, length n.
+        c (np.ndarray): Upper diagonal, length n.
+        d (np.ndarray): Right-hand side, length n.
+        out (np.ndarray, optional): Contiguous float32 vector of length n that
+            receives the solution. Allocated if None.
+
+    Returns:
+        np.ndarray: Solution vector x (float32).
+    """
+    if not hasattr(_lib, "pcr_gpu"):
+        raise RuntimeError("the loaded library was built without pcr_gpu")
+    arrays, diagonals = _system(a, b, c, d, out, True)
+    sle = _triSLE(*[ctypes.pointer(diagonal) for diagonal in diagonals])
+    start, end = _timer(), _timer()
+    _check(
+        _lib.pcr_gpu(ctypes.byref(sle), ctypes.byref(start), ctypes.byref(end)),
+        "pcr_gpu",
+    )
+    return arrays[4]
+
+
+def solve_batched(a, b, c, d, offsets, out=None, overwrite=False):
+    """Solves a batch of independent tridiagonal systems stored back to back.
+
+    System k occupies the rows offsets[k] to offsets[k + 1] - 1 of every
+    diagonal, so a[offsets[k]] and c[offsets[k + 1] - 1] must be zero.
+
+    Args:
+        a (np.ndarray): Lower diagonals of all systems.
+        b (np.ndarray): Main diagonals of all systems.
+        c (np.ndarray): Upper diagonals of all systems.
+        d (np.ndarray): Right-hand sides of all systems.
+        offsets (np.ndarray): count + 1 increasing row offsets, starting at 0
+            and ending at the total number of rows.
+        out (np.ndarray, optional): As for solve().
+        overwrite (bool, optional): As for solve().
+
+    Returns:
+        np.ndarray: Solutions of all systems, stored like d (float32).
+    """
+    arrays, diagonals = _system(a, b, c, d, out, overwrite)
+    rows = arrays[1].shape[0]
+
+    offsets = np.array(offsets, dtype=np.uintp)
+    sizes = np.diff(offsets.astype(np.int64))
+    if (
+        offsets.ndim != 1
+        or offsets.shape[0] < 1
+        or offsets[0] != 0
+        or offsets[-1] != rows
+        or (sizes < 0).any()
+    ):
+        raise ValueError(f"offsets must increase from 0 to {rows}")
+
+    scratch = [np.empty(rows, dtype=np.float32) for _ in range(4)]
+    tmp = [_diagonal_of(array) for array in scratch]
+
+    batch = _triSLE_batch(
+        offsets.shape[0] - 1,
+        offsets.ctypes.data_as(ctypes.POINTER(ctypes.c_size_t)),
+        int(sizes.max()) if sizes.shape[0] > 0 else 0,
+        *[ctypes.pointer(diagonal) for diagonal in diagonals],
+        (ctypes.POINTER(_diagonal) * 4)(*[ctypes.pointer(t) for t in tmp]),
+    )
+    start, end = _timer(), _timer()
+    _check(
+        _lib.pcr_batched(
+            ctypes.byref(batch), ctypes.byref(start), ctypes.byref(end)
+        ),
+        "pcr_batched",
+    )
+    return arrays[4]